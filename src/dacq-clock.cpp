@@ -0,0 +1,193 @@
+/*
+ * dacq-clock.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#include <algorithm>
+#include <errno.h>
+
+#include "dacq-clock.h"
+
+using namespace os;
+using namespace os::rtos;
+
+/**
+ * @brief Constructor.
+ * @param start: initial time, in ticks.
+ */
+dacq_virtual_clock::dacq_virtual_clock (clock::timestamp_t start) :
+    now_
+      { start }
+{
+}
+
+clock::timestamp_t
+dacq_virtual_clock::now (void)
+{
+  mutex_.lock ();
+  clock::timestamp_t t = now_;
+  mutex_.unlock ();
+
+  return t;
+}
+
+void
+dacq_virtual_clock::sleep_until (clock::timestamp_t timestamp)
+{
+  wait (nullptr, nullptr, timestamp);
+}
+
+result_t
+dacq_virtual_clock::timed_wait (semaphore& sem,
+                                clock::duration_t timeout)
+{
+  return wait ([](void* arg)
+    { return static_cast<semaphore*> (arg)->try_wait () == result::ok;},
+               &sem, deadline (timeout));
+}
+
+result_t
+dacq_virtual_clock::timed_lock (os::rtos::mutex& mutex,
+                                clock::duration_t timeout)
+{
+  return wait ([](void* arg)
+    { return static_cast<os::rtos::mutex*> (arg)->try_lock () == result::ok;},
+               &mutex, deadline (timeout));
+}
+
+void
+dacq_virtual_clock::attach (void)
+{
+  mutex_.lock ();
+  participants_++;
+  mutex_.unlock ();
+}
+
+void
+dacq_virtual_clock::detach (void)
+{
+  mutex_.lock ();
+  participants_--;
+  if (waiting_ > 0 && waiting_ >= participants_)
+    {
+      // the remaining threads are all waiting, let them poll again
+      new_round ();
+    }
+  mutex_.unlock ();
+}
+
+/**
+ * @brief Block the calling thread until a condition is true or the
+ *      deadline is reached. The waiting threads poll their conditions in
+ *      rounds: a new round starts whenever all the attached threads are
+ *      waiting after one of them was active; if in a round no condition
+ *      became true, no thread was active meanwhile, so the time can jump to
+ *      the nearest deadline.
+ * @param pred: condition, or nullptr for a plain sleep.
+ * @param arg: parameter passed to the condition.
+ * @param deadline: time when to give up.
+ * @return result::ok if the condition became true, ETIMEDOUT otherwise.
+ */
+result_t
+dacq_virtual_clock::wait (predicate_t pred, void* arg,
+                          clock::timestamp_t deadline)
+{
+  result_t res;
+  bool fresh = true;    // the thread was active until now
+
+  mutex_.lock ();
+  while (true)
+    {
+      if (pred != nullptr && pred (arg))
+        {
+          res = result::ok;
+          break;
+        }
+      if (now_ >= deadline)
+        {
+          res = ETIMEDOUT;
+          break;
+        }
+
+      // a round started by this thread includes this thread too
+      uint32_t round = round_;
+      waiting_++;
+      if (fresh)
+        {
+          // what this thread did may satisfy other threads' conditions
+          clean_ = false;
+          fresh = false;
+        }
+      else
+        {
+          polled_++;
+          next_ = std::min (next_, deadline);
+        }
+
+      if (clean_ && polled_ >= participants_)
+        {
+          if (next_ != never)
+            {
+              now_ = next_;
+              advances_++;
+              new_round ();
+            }
+        }
+      else if (clean_ == false && waiting_ >= participants_)
+        {
+          new_round ();
+        }
+
+      while (round == round_)
+        {
+          cond_.wait (mutex_);
+        }
+      waiting_--;
+    }
+
+  // leaving the wait is an event for the other threads
+  clean_ = false;
+  mutex_.unlock ();
+
+  return res;
+}
+
+clock::timestamp_t
+dacq_virtual_clock::deadline (clock::duration_t timeout)
+{
+  return timeout == forever ? never : now () + timeout;
+}
+
+void
+dacq_virtual_clock::new_round (void)
+{
+  round_++;
+  polled_ = 0;
+  next_ = never;
+  clean_ = true;
+  cond_.broadcast ();
+}
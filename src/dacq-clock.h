@@ -0,0 +1,245 @@
+/*
+ * dacq-clock.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef DACQ_CLOCK_H_
+#define DACQ_CLOCK_H_
+
+#include <cmsis-plus/rtos/os.h>
+
+#if defined (__cplusplus)
+
+/*
+ * The time source used by the drivers: all timestamps, sleeps and timed
+ * waits go through this class. The default implementation uses the RTOS
+ * system clock; a dacq_virtual_clock can be installed instead to run
+ * simulations faster than real time. Times are in system clock ticks.
+ */
+class dacq_clock
+{
+public:
+
+  virtual
+  ~dacq_clock () = default;
+
+  virtual os::rtos::clock::timestamp_t
+  now (void);
+
+  virtual uint64_t
+  now_us (void);
+
+  virtual void
+  sleep_for (os::rtos::clock::duration_t duration);
+
+  virtual void
+  sleep_until (os::rtos::clock::timestamp_t timestamp);
+
+  virtual os::rtos::result_t
+  timed_wait (os::rtos::semaphore& sem,
+              os::rtos::clock::duration_t timeout);
+
+  virtual os::rtos::result_t
+  timed_lock (os::rtos::mutex& mutex, os::rtos::clock::duration_t timeout);
+
+  virtual void
+  attach (void);
+
+  virtual void
+  detach (void);
+
+  // a timeout that never expires
+  static constexpr os::rtos::clock::duration_t forever = 0xFFFFFFFF;
+
+};
+
+/*
+ * A discrete-event clock: time does not flow, it jumps. The threads using
+ * the clock must be attached to it (attach() and detach()); when all of
+ * them are blocked in a sleep or timed wait of this clock, and none of the
+ * awaited events (semaphore posted, mutex released) happened, the time
+ * advances at once to the nearest deadline. A simulated bus thus runs as
+ * fast as the CPU allows, with the same ordering of events as in real
+ * time. Semaphores and mutexes must only be used by attached threads.
+ */
+class dacq_virtual_clock : public dacq_clock
+{
+public:
+
+  dacq_virtual_clock (os::rtos::clock::timestamp_t start = 0);
+
+  os::rtos::clock::timestamp_t
+  now (void) override;
+
+  uint64_t
+  now_us (void) override;
+
+  void
+  sleep_for (os::rtos::clock::duration_t duration) override;
+
+  void
+  sleep_until (os::rtos::clock::timestamp_t timestamp) override;
+
+  os::rtos::result_t
+  timed_wait (os::rtos::semaphore& sem,
+              os::rtos::clock::duration_t timeout) override;
+
+  os::rtos::result_t
+  timed_lock (os::rtos::mutex& mutex, os::rtos::clock::duration_t timeout)
+      override;
+
+  void
+  attach (void) override;
+
+  void
+  detach (void) override;
+
+  uint32_t
+  advances (void);
+
+private:
+
+  typedef bool
+  (*predicate_t) (void* arg);
+
+  os::rtos::result_t
+  wait (predicate_t pred, void* arg, os::rtos::clock::timestamp_t deadline);
+
+  os::rtos::clock::timestamp_t
+  deadline (os::rtos::clock::duration_t timeout);
+
+  void
+  new_round (void);
+
+  static constexpr os::rtos::clock::timestamp_t never = ~0ULL;
+
+  os::rtos::mutex mutex_
+    { "vclock" };
+  os::rtos::condition_variable cond_
+    { "vclock" };
+
+  os::rtos::clock::timestamp_t now_;
+  os::rtos::clock::timestamp_t next_ = never;  // nearest deadline in round
+  uint32_t round_ = 0;          // incremented whenever the waiters must poll
+  int participants_ = 0;        // attached threads
+  int waiting_ = 0;             // attached threads blocked in a wait
+  int polled_ = 0;              // waiters that polled in this round
+  bool clean_ = false;          // no event happened during this round
+  uint32_t advances_ = 0;
+
+};
+
+inline os::rtos::clock::timestamp_t
+dacq_clock::now (void)
+{
+  return os::rtos::sysclock.now ();
+}
+
+/**
+ * @brief Return the time in µs, for timestamps finer than the system clock
+ *      ticks; the high-resolution clock is used.
+ */
+inline uint64_t
+dacq_clock::now_us (void)
+{
+  uint64_t cycles = os::rtos::hrclock.now ();
+  uint32_t hz = os::rtos::hrclock.input_clock_frequency_hz ();
+
+  return (cycles / hz) * 1000000 + ((cycles % hz) * 1000000) / hz;
+}
+
+inline void
+dacq_clock::sleep_for (os::rtos::clock::duration_t duration)
+{
+  os::rtos::sysclock.sleep_for (duration);
+}
+
+inline void
+dacq_clock::sleep_until (os::rtos::clock::timestamp_t timestamp)
+{
+  os::rtos::sysclock.sleep_until (timestamp);
+}
+
+inline os::rtos::result_t
+dacq_clock::timed_wait (os::rtos::semaphore& sem,
+                        os::rtos::clock::duration_t timeout)
+{
+  return sem.timed_wait (timeout);
+}
+
+inline os::rtos::result_t
+dacq_clock::timed_lock (os::rtos::mutex& mutex,
+                        os::rtos::clock::duration_t timeout)
+{
+  return mutex.timed_lock (timeout);
+}
+
+/**
+ * @brief Declare that the calling thread uses this clock (nothing to do
+ *      for the system clock).
+ */
+inline void
+dacq_clock::attach (void)
+{
+}
+
+/**
+ * @brief Declare that the calling thread no longer uses this clock.
+ */
+inline void
+dacq_clock::detach (void)
+{
+}
+
+/**
+ * @brief Return the time in µs; the virtual time has the resolution of the
+ *      system clock ticks.
+ */
+inline uint64_t
+dacq_virtual_clock::now_us (void)
+{
+  return now () * (1000000 / os::rtos::sysclock.frequency_hz);
+}
+
+inline void
+dacq_virtual_clock::sleep_for (os::rtos::clock::duration_t duration)
+{
+  sleep_until (now () + duration);
+}
+
+/**
+ * @brief Return how many times the time advanced.
+ */
+inline uint32_t
+dacq_virtual_clock::advances (void)
+{
+  return advances_;
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* DACQ_CLOCK_H_ */
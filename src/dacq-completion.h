@@ -0,0 +1,257 @@
+/*
+ * dacq-completion.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef DACQ_COMPLETION_H_
+#define DACQ_COMPLETION_H_
+
+#include <atomic>
+#include <cmsis-plus/rtos/os.h>
+#include "dacq.h"
+#include "dacq-clock.h"
+
+#if defined (__cplusplus)
+
+/*
+ * Completion handle of asynchronous retrievals: the driver arms it when
+ * a request is accepted and completes it when the request finished, after
+ * the user call-back (if any) was called. The caller can poll it with
+ * done(), or block on it with wait(); the waits use the driver's clock.
+ * A handle can also follow a group of requests, possibly on several buses:
+ * it is then armed beforehand for the number of requests and it is done
+ * when all of them finished; the result is true only if all succeeded, the
+ * error is the one of the first request that failed and the count is the
+ * total number of values retrieved.
+ */
+class dacq_completion
+{
+public:
+
+  bool
+  done (void);
+
+  bool
+  wait (os::rtos::clock::duration_t timeout = dacq_clock::forever);
+
+  bool
+  result (void);
+
+  const dacq::err_t*
+  error (void);
+
+  uint16_t
+  count (void);
+
+  void
+  arm (dacq_clock* clock, uint16_t requests = 1);
+
+  bool
+  armed (void);
+
+  // called by the driver
+  bool
+  attach (dacq_clock* clock);
+
+  void
+  complete (bool result, const dacq::err_t* error, uint16_t count);
+
+private:
+
+  void
+  reset (dacq_clock* clock, uint16_t requests);
+
+  os::rtos::semaphore_binary sem_
+    { "dacq_done", 0 };
+  os::rtos::mutex mutex_
+    { "dacq_done" };
+  dacq_clock* clock_ = nullptr;
+  // published last, after the outcome (see done())
+  std::atomic<bool> done_
+    { false };
+  uint16_t remaining_ = 0;      // requests not yet finished
+  uint16_t free_ = 0;           // requests armed for, not yet attached
+  bool result_ = false;
+  const dacq::err_t* error_ = nullptr;
+  uint16_t count_ = 0;
+
+};
+
+/**
+ * @brief Check if the request(s) finished (non blocking); once it returns
+ *      true, result(), error() and count() return the final outcome.
+ */
+inline bool
+dacq_completion::done (void)
+{
+  return done_.load (std::memory_order_acquire);
+}
+
+/**
+ * @brief Wait for the request(s) to finish.
+ * @param timeout: maximum time to wait, in ms.
+ * @return true if the request(s) finished, false if the timeout expired.
+ */
+inline bool
+dacq_completion::wait (os::rtos::clock::duration_t timeout)
+{
+  if (done () == false && clock_ != nullptr
+      && clock_->timed_wait (sem_, timeout) == os::rtos::result::ok)
+    {
+      sem_.post ();     // let further waits return at once
+    }
+  return done ();
+}
+
+/**
+ * @brief Return true if the data was retrieved, false otherwise.
+ */
+inline bool
+dacq_completion::result (void)
+{
+  return result_;
+}
+
+/**
+ * @brief Return the error of a failed request, or nullptr.
+ */
+inline const dacq::err_t*
+dacq_completion::error (void)
+{
+  return error_;
+}
+
+/**
+ * @brief Return the number of values retrieved.
+ */
+inline uint16_t
+dacq_completion::count (void)
+{
+  return count_;
+}
+
+/**
+ * @brief Prepare the handle for new requests.
+ * @param clock: the clock used by wait().
+ * @param requests: number of requests the handle follows.
+ */
+inline void
+dacq_completion::arm (dacq_clock* clock, uint16_t requests)
+{
+  mutex_.lock ();
+  reset (clock, requests);
+  mutex_.unlock ();
+}
+
+/**
+ * @brief Check if the handle still follows unfinished requests.
+ */
+inline bool
+dacq_completion::armed (void)
+{
+  mutex_.lock ();
+  bool result = remaining_ > 0;
+  mutex_.unlock ();
+  return result;
+}
+
+/**
+ * @brief Attach a request to the handle: one of the requests it was armed
+ *      for or, if it follows no request, a single new one.
+ * @param clock: the clock used by wait(), if the handle is armed here.
+ * @return true if attached, false if the handle already follows as many
+ *      unfinished requests as it was armed for.
+ */
+inline bool
+dacq_completion::attach (dacq_clock* clock)
+{
+  bool result = false;
+
+  mutex_.lock ();
+  if (remaining_ == 0)
+    {
+      reset (clock, 1);
+    }
+  if (free_ > 0)
+    {
+      free_--;
+      result = true;
+    }
+  mutex_.unlock ();
+
+  return result;
+}
+
+/**
+ * @brief Prepare the handle for new requests; the mutex must be locked.
+ */
+inline void
+dacq_completion::reset (dacq_clock* clock, uint16_t requests)
+{
+  sem_.try_wait ();
+  clock_ = clock;
+  result_ = true;
+  error_ = nullptr;
+  count_ = 0;
+  remaining_ = requests;
+  free_ = requests;
+  done_.store (requests == 0, std::memory_order_release);
+  if (requests == 0)
+    {
+      sem_.post ();
+    }
+}
+
+/**
+ * @brief Record the outcome of a request; when all requests finished,
+ *      wake up the waiters.
+ * @param result: true if the data was retrieved, false otherwise.
+ * @param error: the error of the request.
+ * @param count: number of values retrieved.
+ */
+inline void
+dacq_completion::complete (bool result, const dacq::err_t* error,
+                           uint16_t count)
+{
+  mutex_.lock ();
+  if (result == false && result_ == true)
+    {
+      result_ = false;
+      error_ = error;
+    }
+  count_ += count;
+  if (remaining_ > 0 && --remaining_ == 0)
+    {
+      done_.store (true, std::memory_order_release);
+      sem_.post ();
+    }
+  mutex_.unlock ();
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* DACQ_COMPLETION_H_ */
@@ -0,0 +1,168 @@
+/*
+ * dacq-dispatch.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+/*
+ * This file implements the deferred dispatch of the user call-backs.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+#include "dacq-dispatch.h"
+
+using namespace os;
+using namespace os::rtos;
+
+/**
+ * @brief Queue a completed retrieval.
+ * @param dacqh: pointer on the handle; it must stay valid until its
+ *      call-back was called.
+ * @param release: function called after the call-back, or nullptr.
+ * @param owner: first parameter of the release function.
+ * @param context: second parameter of the release function.
+ * @return true if successful, false if the queue is full.
+ */
+bool
+dacq_dispatch::post (dacq::dacq_handle_t* dacqh, release_t release,
+                     void* owner, void* context)
+{
+  bool result = false;
+
+  mutex_.lock ();
+  if (count_ < DACQ_DISPATCH_QUEUE)
+    {
+      item_t* item = &items_[(head_ + count_) % DACQ_DISPATCH_QUEUE];
+      item->dacqh = dacqh;
+      item->release = release;
+      item->owner = owner;
+      item->context = context;
+      count_++;
+      stats_.posted++;
+      if (count_ > stats_.high_water)
+        {
+          stats_.high_water = count_;
+        }
+      result = true;
+    }
+  else
+    {
+      stats_.overflows++;
+    }
+  mutex_.unlock ();
+
+  if (result)
+    {
+      notify ();
+    }
+
+  return result;
+}
+
+/**
+ * @brief Call the call-backs of the queued handles, in the order they were
+ *      posted, from the calling thread.
+ * @param max: maximum number of call-backs to call.
+ * @return the number of call-backs called.
+ */
+size_t
+dacq_dispatch::drain (size_t max)
+{
+  size_t done = 0;
+
+  while (done < max)
+    {
+      item_t item;
+
+      mutex_.lock ();
+      if (count_ == 0)
+        {
+          mutex_.unlock ();
+          break;
+        }
+      item = items_[head_];
+      head_ = (head_ + 1) % DACQ_DISPATCH_QUEUE;
+      count_--;
+      stats_.dispatched++;
+      mutex_.unlock ();
+
+      if (item.dacqh->cb != nullptr)
+        {
+          item.dacqh->cb (item.dacqh);
+        }
+      if (item.release != nullptr)
+        {
+          item.release (item.owner, item.context);
+        }
+      done++;
+    }
+
+  return done;
+}
+
+/**
+ * @brief Constructor.
+ */
+dacq_dispatch_thread::dacq_dispatch_thread (void)
+{
+}
+
+/**
+ * @brief Install the time source used by the dispatch thread to wait (see
+ *      sdi12_dr::set_clock()).
+ * @param clock: pointer to the clock; if nullptr, the system clock is
+ *      restored.
+ */
+void
+dacq_dispatch_thread::set_clock (dacq_clock* clock)
+{
+  clock = clock ? clock : &default_clock_;
+  // the dispatch thread is a user of the clock; wake it up, so that it
+  // waits on the new clock
+  clock->attach ();
+  clock_->detach ();
+  clock_ = clock;
+  sem_.post ();
+}
+
+/**
+ * @brief Thread calling the call-backs of the posted handles.
+ * @param args: pointer on the class ("this").
+ */
+void*
+dacq_dispatch_thread::run (void* args)
+{
+  dacq_dispatch_thread* self = static_cast<dacq_dispatch_thread*> (args);
+
+  while (true)
+    {
+      self->clock_->timed_wait (self->sem_, dacq_clock::forever);
+      self->drain ();
+    }
+
+  return nullptr;
+}
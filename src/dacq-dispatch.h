@@ -0,0 +1,186 @@
+/*
+ * dacq-dispatch.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef DACQ_DISPATCH_H_
+#define DACQ_DISPATCH_H_
+
+#include <cmsis-plus/rtos/os.h>
+#include "dacq.h"
+#include "dacq-clock.h"
+
+#ifndef DACQ_DISPATCH_QUEUE
+#define DACQ_DISPATCH_QUEUE 16  // results
+#endif
+
+#if defined (__cplusplus)
+
+/*
+ * Queue of completed retrievals whose user call-backs are still to be
+ * called. A driver with a queue installed posts the handles (pointers, the
+ * handles are not copied) instead of calling the call-backs with the bus
+ * locked; the call-backs are then called by drain(), from the thread that
+ * polls the queue, or by the thread of a dacq_dispatch_thread. The queue
+ * is bounded: when it is full, the driver calls the call-back at once and
+ * the overflow is counted. A release function can be posted with a handle,
+ * to be called after its call-back (the driver frees its request entry).
+ */
+class dacq_dispatch
+{
+public:
+
+  typedef void
+  (*release_t) (void* owner, void* context);
+
+  typedef struct stats_
+  {
+    uint32_t posted;            // handles queued
+    uint32_t dispatched;        // call-backs called from the queue
+    uint32_t overflows;         // handles refused, the queue was full
+    uint16_t high_water;        // maximum number of queued handles
+  } stats_t;
+
+  virtual
+  ~dacq_dispatch () = default;
+
+  bool
+  post (dacq::dacq_handle_t* dacqh, release_t release = nullptr,
+        void* owner = nullptr, void* context = nullptr);
+
+  size_t
+  drain (size_t max = DACQ_DISPATCH_QUEUE);
+
+  size_t
+  pending (void);
+
+  const stats_t&
+  stats (void);
+
+  void
+  reset_stats (void);
+
+  static constexpr size_t capacity = DACQ_DISPATCH_QUEUE;
+
+protected:
+
+  virtual void
+  notify (void);
+
+private:
+
+  typedef struct item_
+  {
+    dacq::dacq_handle_t* dacqh;
+    release_t release;
+    void* owner;
+    void* context;
+  } item_t;
+
+  item_t items_[DACQ_DISPATCH_QUEUE];
+  size_t head_ = 0;     // next item to dispatch
+  size_t count_ = 0;    // queued items
+  stats_t stats_ = { };
+
+  os::rtos::mutex mutex_
+    { "dacq_disp" };
+
+};
+
+/*
+ * A dispatch queue with its own thread, calling the call-backs as soon as
+ * the handles are posted.
+ */
+class dacq_dispatch_thread : public dacq_dispatch
+{
+public:
+
+  dacq_dispatch_thread (void);
+
+  void
+  set_clock (dacq_clock* clock);
+
+protected:
+
+  void
+  notify (void) override;
+
+private:
+
+  static void*
+  run (void* args);
+
+  dacq_clock default_clock_;
+  dacq_clock* clock_ = &default_clock_;
+
+  os::rtos::semaphore_counting sem_
+    { "dacq_disp", DACQ_DISPATCH_QUEUE, 0 };
+  os::rtos::thread th_
+    { "dacq-dispatch", run, static_cast<void*> (this) };
+
+};
+
+/**
+ * @brief Return the number of queued handles.
+ */
+inline size_t
+dacq_dispatch::pending (void)
+{
+  return count_;
+}
+
+inline const dacq_dispatch::stats_t&
+dacq_dispatch::stats (void)
+{
+  return stats_;
+}
+
+inline void
+dacq_dispatch::reset_stats (void)
+{
+  mutex_.lock ();
+  stats_ = { };
+  mutex_.unlock ();
+}
+
+/**
+ * @brief Called when a handle was posted; nothing to do for a polled queue.
+ */
+inline void
+dacq_dispatch::notify (void)
+{
+}
+
+inline void
+dacq_dispatch_thread::notify (void)
+{
+  sem_.post ();
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* DACQ_DISPATCH_H_ */
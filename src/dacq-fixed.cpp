@@ -0,0 +1,215 @@
+/*
+ * dacq-fixed.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+/*
+ * This file implements the helpers for fixed-point values.
+ */
+
+#include "dacq-fixed.h"
+
+/**
+ * @brief Multiply a mantissa by a power of 10, or divide it by one,
+ *      rounding half away from zero.
+ * @param mantissa: the mantissa.
+ * @param n: the power of 10, negative to divide.
+ * @return the scaled mantissa.
+ */
+int64_t
+dacq_fixed::scale (int64_t mantissa, int n)
+{
+  if (n >= 0)
+    {
+      return mantissa * pow10 (n);
+    }
+
+  int64_t p = pow10 (-n);
+  return (mantissa + (mantissa < 0 ? -p / 2 : p / 2)) / p;
+}
+
+/**
+ * @brief Express a value with another exponent, e.g. to store values of
+ *      different precisions in the same format.
+ * @param value: the value.
+ * @param exponent: the new exponent.
+ * @param mantissa: returns the mantissa for the new exponent; if the new
+ *      exponent is larger, the mantissa is rounded.
+ * @return true if successful, false if the mantissa does not fit.
+ */
+bool
+dacq_fixed::rescale (dacq_fixed_t value, int8_t exponent, int32_t& mantissa)
+{
+  int64_t m = scale (value.mantissa, value.exponent - exponent);
+
+  if (m > INT32_MAX || m < INT32_MIN)
+    {
+      return false;
+    }
+  mantissa = m;
+  return true;
+}
+
+/**
+ * @brief Compare two values.
+ * @return a negative number if a < b, 0 if they are equal, a positive
+ *      number otherwise.
+ */
+int
+dacq_fixed::compare (dacq_fixed_t a, dacq_fixed_t b)
+{
+  int8_t e = a.exponent < b.exponent ? a.exponent : b.exponent;
+  int64_t x = scale (a.mantissa, a.exponent - e);
+  int64_t y = scale (b.mantissa, b.exponent - e);
+
+  return x < y ? -1 : x > y;
+}
+
+/**
+ * @brief Format a value the way SDI-12 sensors send it (sign, digits and
+ *      decimal point, e.g. "+12.345"), e.g. to store or forward it without
+ *      converting it to float.
+ * @param value: the value.
+ * @param buff: buffer for the text, zero terminated.
+ * @param len: length of the buffer.
+ * @return the length of the text, or 0 if the buffer is too small.
+ */
+size_t
+dacq_fixed::to_ascii (dacq_fixed_t value, char* buff, size_t len)
+{
+  char digits[24];
+  size_t n = 0;
+  size_t pos = 0;
+  int64_t m = value.mantissa;
+
+  if (m < 0)
+    {
+      m = -m;
+    }
+  for (int i = value.exponent; i > 0; i--)
+    {
+      digits[n++] = '0';        // positive exponent, trailing zeros
+    }
+  do
+    {
+      digits[n++] = '0' + m % 10;
+      m /= 10;
+    }
+  while (m > 0 || (int) n <= -value.exponent);
+
+  if (n + 3 > len)
+    {
+      return 0;
+    }
+  buff[pos++] = value.mantissa < 0 ? '-' : '+';
+  while (n > 0)
+    {
+      if (value.exponent < 0 && (int) n == -value.exponent)
+        {
+          buff[pos++] = '.';
+        }
+      buff[pos++] = digits[--n];
+    }
+  buff[pos] = '\0';
+
+  return pos;
+}
+
+/**
+ * @brief Convert a value to float, if needed after all.
+ */
+float
+dacq_fixed::to_float (dacq_fixed_t value)
+{
+  return value.exponent < 0 ?
+      (float) value.mantissa / (float) pow10 (-value.exponent) :
+      (float) (value.mantissa * pow10 (value.exponent));
+}
+
+/**
+ * @brief Clear the aggregated values.
+ */
+void
+dacq_fixed_acc::reset (void)
+{
+  count_ = 0;
+  sum_ = 0;
+  exponent_ = 0;
+  min_ = max_ =
+    { 0, 0 };
+}
+
+/**
+ * @brief Add a value.
+ * @param value: the value.
+ */
+void
+dacq_fixed_acc::add (dacq_fixed_t value)
+{
+  if (count_ == 0)
+    {
+      exponent_ = value.exponent;
+      min_ = max_ = value;
+    }
+  else
+    {
+      if (dacq_fixed::compare (value, min_) < 0)
+        {
+          min_ = value;
+        }
+      if (dacq_fixed::compare (value, max_) > 0)
+        {
+          max_ = value;
+        }
+    }
+  if (value.exponent < exponent_)
+    {
+      // finer value, scale the sum
+      sum_ = dacq_fixed::scale (sum_, exponent_ - value.exponent);
+      exponent_ = value.exponent;
+    }
+  sum_ += dacq_fixed::scale (value.mantissa, value.exponent - exponent_);
+  count_++;
+}
+
+/**
+ * @brief Return the mean of the values, with the finest exponent of the
+ *      values, rounded.
+ */
+dacq_fixed_t
+dacq_fixed_acc::mean (void)
+{
+  dacq_fixed_t result =
+    { 0, exponent_ };
+
+  if (count_ > 0)
+    {
+      int64_t half = sum_ < 0 ? -(int64_t) (count_ / 2) : count_ / 2;
+      result.mantissa = (sum_ + half) / (int64_t) count_;
+    }
+  return result;
+}
@@ -0,0 +1,170 @@
+/*
+ * dacq-fixed.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef DACQ_FIXED_H_
+#define DACQ_FIXED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined (__cplusplus)
+
+/*
+ * A value as sent by the sensor: an integer mantissa and a decimal
+ * exponent, e.g. "+12.345" is { 12345, -3 }. The precision of the sensor
+ * is kept, and targets without FPU process the values without floating
+ * point arithmetic. Exponents are expected between -9 and 9.
+ */
+typedef struct dacq_fixed_
+{
+  int32_t mantissa;
+  int8_t exponent;
+} dacq_fixed_t;
+
+/*
+ * Helpers for fixed-point values.
+ */
+class dacq_fixed
+{
+public:
+
+  static bool
+  rescale (dacq_fixed_t value, int8_t exponent, int32_t& mantissa);
+
+  static int
+  compare (dacq_fixed_t a, dacq_fixed_t b);
+
+  static size_t
+  to_ascii (dacq_fixed_t value, char* buff, size_t len);
+
+  static float
+  to_float (dacq_fixed_t value);
+
+  static int64_t
+  pow10 (int n);
+
+  static int64_t
+  scale (int64_t mantissa, int n);
+
+};
+
+/*
+ * Aggregation of fixed-point values (count, sum, mean, minimum and
+ * maximum) without floating point arithmetic. The sum is kept with the
+ * finest exponent seen so far.
+ */
+class dacq_fixed_acc
+{
+public:
+
+  void
+  reset (void);
+
+  void
+  add (dacq_fixed_t value);
+
+  uint32_t
+  count (void);
+
+  int64_t
+  sum (int8_t& exponent);
+
+  dacq_fixed_t
+  mean (void);
+
+  dacq_fixed_t
+  min (void);
+
+  dacq_fixed_t
+  max (void);
+
+private:
+
+  uint32_t count_ = 0;
+  int64_t sum_ = 0;
+  int8_t exponent_ = 0;
+  dacq_fixed_t min_ =
+    { 0, 0 };
+  dacq_fixed_t max_ =
+    { 0, 0 };
+
+};
+
+/**
+ * @brief Return 10 to the power of n.
+ * @param n: exponent, between 0 and 18.
+ */
+inline int64_t
+dacq_fixed::pow10 (int n)
+{
+  int64_t p = 1;
+
+  while (n-- > 0)
+    {
+      p *= 10;
+    }
+  return p;
+}
+
+/**
+ * @brief Return the number of values added since the last reset.
+ */
+inline uint32_t
+dacq_fixed_acc::count (void)
+{
+  return count_;
+}
+
+/**
+ * @brief Return the sum of the values.
+ * @param exponent: returns the exponent of the sum.
+ * @return the mantissa of the sum.
+ */
+inline int64_t
+dacq_fixed_acc::sum (int8_t& exponent)
+{
+  exponent = exponent_;
+  return sum_;
+}
+
+inline dacq_fixed_t
+dacq_fixed_acc::min (void)
+{
+  return min_;
+}
+
+inline dacq_fixed_t
+dacq_fixed_acc::max (void)
+{
+  return max_;
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* DACQ_FIXED_H_ */
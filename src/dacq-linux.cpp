@@ -0,0 +1,252 @@
+/*
+ * dacq-linux.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+#include "dacq-linux.h"
+
+#if DACQ_HOST == true
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+using namespace os;
+using namespace os::rtos;
+
+/**
+ * @brief Constructor.
+ * @param name: the path of a tty device (e.g. /dev/ttyUSB0), or nullptr
+ *      for a pty pair.
+ */
+dacq_linux::dacq_linux (const char* name) :
+    name_ (name), fd_ (-1), own_ (true)
+{
+}
+
+/**
+ * @brief Constructor for an already open file descriptor; the descriptor
+ *      is not closed by the destructor.
+ * @param fd: the file descriptor.
+ */
+dacq_linux::dacq_linux (int fd) :
+    name_ (nullptr), fd_ (fd), own_ (false)
+{
+}
+
+/**
+ * @brief Destructor.
+ */
+dacq_linux::~dacq_linux ()
+{
+  if (own_ && fd_ >= 0)
+    {
+      close ();
+    }
+}
+
+/**
+ * @brief Open the tty device, or a pty pair if no name was given.
+ */
+bool
+dacq_linux::open (void)
+{
+  if (name_ == nullptr)
+    {
+      return open_pty ();
+    }
+  fd_ = ::open (name_, O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+  return fd_ >= 0;
+}
+
+/**
+ * @brief Open a pty pair: the slave side is used as the serial port, the
+ *      master side is left to a peer (see peer()).
+ * @return true if successful, false otherwise.
+ */
+bool
+dacq_linux::open_pty (void)
+{
+  peer_ = posix_openpt (O_RDWR | O_NOCTTY);
+  if (peer_ < 0)
+    {
+      return false;
+    }
+
+  const char* slave;
+  if (grantpt (peer_) < 0 || unlockpt (peer_) < 0
+      || (slave = ptsname (peer_)) == nullptr
+      || (fd_ = ::open (slave, O_RDWR | O_NOCTTY | O_NONBLOCK)) < 0)
+    {
+      ::close (peer_);
+      peer_ = -1;
+      return false;
+    }
+
+  return true;
+}
+
+/**
+ * @brief Close the tty device (and the master side of a pty pair).
+ */
+void
+dacq_linux::close (void)
+{
+  ::close (fd_);
+  fd_ = -1;
+  if (peer_ >= 0)
+    {
+      ::close (peer_);
+      peer_ = -1;
+    }
+}
+
+/**
+ * @brief Set baud rate, character size, parity and receive timeout. The
+ *      port is set in raw mode; the receive timeout is implemented with
+ *      poll(), with millisecond resolution.
+ */
+bool
+dacq_linux::set_attributes (speed_t baudrate, uint32_t c_size,
+                            uint32_t parity, uint32_t rec_timeout)
+{
+  static const struct
+  {
+    speed_t baudrate;
+    speed_t speed;
+  } speeds[] =
+    {
+      { 300, B300 },
+      { 600, B600 },
+      { 1200, B1200 },
+      { 2400, B2400 },
+      { 4800, B4800 },
+      { 9600, B9600 },
+      { 19200, B19200 },
+      { 38400, B38400 },
+      { 57600, B57600 },
+      { 115200, B115200 }, };
+
+  struct termios tio;
+  if (tcgetattr (fd_, &tio) < 0)
+    {
+      return false;
+    }
+
+  cfmakeraw (&tio);
+  tio.c_cflag &= ~(CSIZE | PARENB | PARODD | CSTOPB);
+  tio.c_cflag |= c_size | parity | CREAD | CLOCAL;
+  tio.c_cc[VTIME] = 0;
+  tio.c_cc[VMIN] = 0;
+
+  for (auto& s : speeds)
+    {
+      if (s.baudrate == baudrate)
+        {
+          cfsetispeed (&tio, s.speed);
+          cfsetospeed (&tio, s.speed);
+          break;
+        }
+    }
+
+  if (tcsetattr (fd_, TCSANOW, &tio) < 0)
+    {
+      return false;
+    }
+  rec_timeout_ = rec_timeout;
+
+  return true;
+}
+
+/**
+ * @brief Read with a specific timeout, in ms.
+ */
+ssize_t
+dacq_linux::read (void* buff, size_t count, uint32_t timeout)
+{
+  struct pollfd pfd =
+    { fd_, POLLIN, 0 };
+  clock::timestamp_t deadline = sysclock.now () + timeout;
+  int result;
+
+  do
+    {
+      clock::timestamp_t now = sysclock.now ();
+      result = poll (&pfd, 1, deadline > now ? (int) (deadline - now) : 0);
+    }
+  while (result < 0 && errno == EINTR);
+
+  if (result <= 0)
+    {
+      return result;
+    }
+
+  ssize_t count_read = ::read (fd_, buff, count);
+  if (count_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      count_read = 0;
+    }
+
+  return count_read;
+}
+
+ssize_t
+dacq_linux::write (const void* buff, size_t count)
+{
+  return ::write (fd_, buff, count);
+}
+
+/**
+ * @brief Send a break of the given duration. Ptys accept the request but
+ *      do not forward the break; the line is still held for 'duration'.
+ */
+int
+dacq_linux::send_break (int duration)
+{
+  int result = ioctl (fd_, TIOCSBRK);
+  sysclock.sleep_for (duration);
+  if (result == 0)
+    {
+      result = ioctl (fd_, TIOCCBRK);
+    }
+
+  return result < 0 ? -1 : 0;
+}
+
+int
+dacq_linux::flush (int queue)
+{
+  return tcflush (fd_, queue);
+}
+
+#endif // DACQ_HOST == true
@@ -0,0 +1,127 @@
+/*
+ * dacq-linux.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef DACQ_LINUX_H_
+#define DACQ_LINUX_H_
+
+#include "dacq-transport.h"
+
+#if defined (__cplusplus)
+
+/*
+ * Transport backend for a Linux host, using a termios file descriptor: a
+ * serial port, an already open descriptor or the slave side of a pty pair
+ * (if constructed with a null name); the master side of the pty, returned
+ * by peer(), is then served by e.g. a simulator.
+ */
+class dacq_linux : public dacq_transport
+{
+public:
+
+  dacq_linux (const char* name);
+
+  dacq_linux (int fd);
+
+  virtual
+  ~dacq_linux ();
+
+  bool
+  open (void) override;
+
+  void
+  close (void) override;
+
+  bool
+  is_open (void) override;
+
+  bool
+  set_attributes (speed_t baudrate, uint32_t c_size, uint32_t parity,
+                  uint32_t rec_timeout) override;
+
+  ssize_t
+  read (void* buff, size_t count) override;
+
+  ssize_t
+  read (void* buff, size_t count, uint32_t timeout) override;
+
+  ssize_t
+  write (const void* buff, size_t count) override;
+
+  int
+  send_break (int duration) override;
+
+  int
+  flush (int queue) override;
+
+  int
+  fd (void);
+
+  int
+  peer (void);
+
+private:
+
+  bool
+  open_pty (void);
+
+  const char* name_;
+  int fd_;
+  int peer_ = -1;
+  bool own_;
+  uint32_t rec_timeout_ = 0;
+
+};
+
+inline bool
+dacq_linux::is_open (void)
+{
+  return fd_ >= 0;
+}
+
+inline ssize_t
+dacq_linux::read (void* buff, size_t count)
+{
+  return read (buff, count, rec_timeout_);
+}
+
+inline int
+dacq_linux::fd (void)
+{
+  return fd_;
+}
+
+inline int
+dacq_linux::peer (void)
+{
+  return peer_;
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* DACQ_LINUX_H_ */
@@ -0,0 +1,138 @@
+/*
+ * dacq-transport.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef DACQ_TRANSPORT_H_
+#define DACQ_TRANSPORT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "dacq-config.h"
+
+#ifndef DACQ_HOST
+#define DACQ_HOST false         // build for a Linux host
+#endif
+
+#if DACQ_HOST == true
+#include <termios.h>
+#else
+#include <cmsis-plus/posix/termios.h>
+#endif
+
+#if defined (__cplusplus)
+
+/*
+ * The interface between the DACQ classes and the serial port they use.
+ * The backends are dacq_tty (a uOS++ tty, on the target) and dacq_linux
+ * (a termios file descriptor or pty, on a Linux host); other transports
+ * (e.g. a simulated bus) can be passed to the dacq constructor.
+ */
+class dacq_transport
+{
+public:
+
+  virtual
+  ~dacq_transport () = default;
+
+  /**
+   * @brief Open the serial port.
+   * @return true if successful, false otherwise.
+   */
+  virtual bool
+  open (void) = 0;
+
+  /**
+   * @brief Close the serial port.
+   */
+  virtual void
+  close (void) = 0;
+
+  /**
+   * @brief Check if the serial port is open.
+   */
+  virtual bool
+  is_open (void) = 0;
+
+  /**
+   * @brief Change the serial port attributes; all parameters as per the
+   *    definitions in termios.h.
+   * @param baudrate: baud rate.
+   * @param c_size: character size (CS5, CS6, CS7 or CS8).
+   * @param parity: parity (0 or PARENB | PARODD)
+   * @param rec_timeout: default receive timeout, in ms.
+   * @return true if successful, false otherwise.
+   */
+  virtual bool
+  set_attributes (speed_t baudrate, uint32_t c_size, uint32_t parity,
+                  uint32_t rec_timeout) = 0;
+
+  /**
+   * @brief Read characters, waiting at most the default receive timeout
+   *    for the first one.
+   * @return number of characters read, 0 on timeout or -1 on error.
+   */
+  virtual ssize_t
+  read (void* buff, size_t count) = 0;
+
+  /**
+   * @brief Read characters, waiting at most 'timeout' ms for the first one.
+   * @return number of characters read, 0 on timeout or -1 on error.
+   */
+  virtual ssize_t
+  read (void* buff, size_t count, uint32_t timeout) = 0;
+
+  /**
+   * @brief Write characters.
+   * @return number of characters written or -1 on error.
+   */
+  virtual ssize_t
+  write (const void* buff, size_t count) = 0;
+
+  /**
+   * @brief Send a break.
+   * @param duration: break length, in ms.
+   * @return 0 if successful, -1 otherwise.
+   */
+  virtual int
+  send_break (int duration) = 0;
+
+  /**
+   * @brief Discard pending data.
+   * @param queue: TCIFLUSH, TCOFLUSH or TCIOFLUSH.
+   * @return 0 if successful, -1 otherwise.
+   */
+  virtual int
+  flush (int queue) = 0;
+
+};
+
+#endif /* (__cplusplus) */
+
+#endif /* DACQ_TRANSPORT_H_ */
@@ -0,0 +1,177 @@
+/*
+ * dacq-tty.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+#include "dacq-transport.h"
+
+#if DACQ_HOST == false
+
+#include "dacq-tty.h"
+
+using namespace os;
+using namespace os::rtos;
+
+/**
+ * @brief Constructor.
+ * @param name: the path of a tty device (serial port).
+ */
+dacq_tty::dacq_tty (const char* name) :
+    name_ (name), tty_ (nullptr)
+{
+}
+
+/**
+ * @brief Constructor for an already open tty.
+ * @param tty: pointer to the tty.
+ */
+dacq_tty::dacq_tty (os::posix::tty* tty) :
+    name_ (nullptr), tty_ (tty)
+{
+}
+
+/**
+ * @brief Open the tty device.
+ */
+bool
+dacq_tty::open (void)
+{
+  tty_ = static_cast<os::posix::tty*> (os::posix::open (name_, 0));
+
+  return tty_ != nullptr;
+}
+
+/**
+ * @brief Close the tty device.
+ */
+void
+dacq_tty::close (void)
+{
+  tty_->close ();
+  tty_ = nullptr;
+}
+
+/**
+ * @brief Set baud rate, character size, parity and receive timeout.
+ */
+bool
+dacq_tty::set_attributes (speed_t baudrate, uint32_t c_size, uint32_t parity,
+                          uint32_t rec_timeout)
+{
+  struct termios tio;
+  if (tty_->tcgetattr (&tio) < 0)
+    {
+      return false;
+    }
+  tio.c_cc[VTIME] = (rec_timeout / 100) & 0xFF;
+  tio.c_cc[VTIME_MS] = rec_timeout % 100;
+  tio.c_cc[VMIN] = 0;
+
+  // set baud rate, character size and parity, if any
+  tio.c_ospeed = tio.c_ispeed = baudrate;
+  tio.c_cflag = c_size | parity;
+
+  if (tty_->tcsetattr (TCSANOW, &tio) < 0)
+    {
+      return false;
+    }
+  rec_timeout_ = timeout_ = rec_timeout;
+
+  return true;
+}
+
+/**
+ * @brief Read using the default receive timeout.
+ */
+ssize_t
+dacq_tty::read (void* buff, size_t count)
+{
+  if (set_timeout (rec_timeout_) == false)
+    {
+      return -1;
+    }
+
+  return tty_->read (buff, count);
+}
+
+/**
+ * @brief Read with a specific timeout. Timeouts shorter than the default
+ *      receive timeout are set on the tty (and kept until the next read
+ *      with a different timeout); longer timeouts are served by repeated
+ *      reads, without changing the tty attributes.
+ */
+ssize_t
+dacq_tty::read (void* buff, size_t count, uint32_t timeout)
+{
+  if (timeout < rec_timeout_)
+    {
+      if (set_timeout (timeout) == false)
+        {
+          return -1;
+        }
+      return tty_->read (buff, count);
+    }
+
+  clock::timestamp_t deadline = sysclock.now () + timeout;
+  ssize_t result;
+  do
+    {
+      result = read (buff, count);
+    }
+  while (result == 0 && sysclock.now () < deadline);
+
+  return result;
+}
+
+/**
+ * @brief Set the receive timeout on the tty, if different.
+ */
+bool
+dacq_tty::set_timeout (uint32_t timeout)
+{
+  if (timeout != timeout_)
+    {
+      struct termios tio;
+      if (tty_->tcgetattr (&tio) < 0)
+        {
+          return false;
+        }
+      tio.c_cc[VTIME] = (timeout / 100) & 0xFF;
+      tio.c_cc[VTIME_MS] = timeout % 100;
+      if (tty_->tcsetattr (TCSANOW, &tio) < 0)
+        {
+          return false;
+        }
+      timeout_ = timeout;
+    }
+
+  return true;
+}
+
+#endif // DACQ_HOST == false
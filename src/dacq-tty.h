@@ -0,0 +1,119 @@
+/*
+ * dacq-tty.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef DACQ_TTY_H_
+#define DACQ_TTY_H_
+
+#include <cmsis-plus/rtos/os.h>
+#include "uart-drv.h"
+#include "dacq-transport.h"
+
+#if defined (__cplusplus)
+
+/*
+ * Transport backend for a uOS++ tty device.
+ */
+class dacq_tty : public dacq_transport
+{
+public:
+
+  dacq_tty (const char* name);
+
+  dacq_tty (os::posix::tty* tty);
+
+  virtual
+  ~dacq_tty () = default;
+
+  bool
+  open (void) override;
+
+  void
+  close (void) override;
+
+  bool
+  is_open (void) override;
+
+  bool
+  set_attributes (speed_t baudrate, uint32_t c_size, uint32_t parity,
+                  uint32_t rec_timeout) override;
+
+  ssize_t
+  read (void* buff, size_t count) override;
+
+  ssize_t
+  read (void* buff, size_t count, uint32_t timeout) override;
+
+  ssize_t
+  write (const void* buff, size_t count) override;
+
+  int
+  send_break (int duration) override;
+
+  int
+  flush (int queue) override;
+
+private:
+
+  bool
+  set_timeout (uint32_t timeout);
+
+  const char* name_;
+  os::posix::tty* tty_;
+  uint32_t rec_timeout_ = 0;    // default receive timeout
+  uint32_t timeout_ = 0;        // receive timeout set on the tty
+
+};
+
+inline bool
+dacq_tty::is_open (void)
+{
+  return tty_ != nullptr;
+}
+
+inline ssize_t
+dacq_tty::write (const void* buff, size_t count)
+{
+  return tty_->write (buff, count);
+}
+
+inline int
+dacq_tty::send_break (int duration)
+{
+  return tty_->tcsendbreak (duration);
+}
+
+inline int
+dacq_tty::flush (int queue)
+{
+  return tty_->tcflush (queue);
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* DACQ_TTY_H_ */
@@ -30,10 +30,14 @@
 #include <inttypes.h>
 #include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
-#include <cmsis-plus/posix-io/file-descriptors-manager.h>
 
 #include "dacq.h"
 
+// DACQ_HOST is defined by now, see dacq-transport.h
+#if DACQ_HOST == false
+#include <cmsis-plus/posix-io/file-descriptors-manager.h>
+#endif
+
 using namespace os;
 using namespace os::rtos;
 
@@ -44,12 +48,27 @@ using namespace os::rtos;
  * @brief Constructor.
  * @param name: the path of a tty device (serial port).
  */
-dacq::dacq (const char* name)
+dacq::dacq (const char* name) :
+    default_transport_
+      { name }
 {
   trace::printf ("%s() %p\n", __func__, this);
 
-  name_ = name;
-  tty_ = nullptr;
+  transport_ = &default_transport_;
+  dump_fn_ = nullptr;
+}
+
+/**
+ * @brief Constructor for a specific transport (e.g. a simulated bus).
+ * @param transport: the transport to use.
+ */
+dacq::dacq (dacq_transport& transport) :
+    default_transport_
+      { static_cast<const char*> (nullptr) }
+{
+  trace::printf ("%s() %p\n", __func__, this);
+
+  transport_ = &transport;
   dump_fn_ = nullptr;
 }
 
@@ -79,40 +98,30 @@ dacq::open (speed_t baudrate, uint32_t c_size, uint32_t parity,
 
   do
     {
-      if (tty_)
+      if (transport_->is_open ())
         {
           err_no = tty_in_use;
           break;        // already in use
         }
 
-      tty_ = static_cast<os::posix::tty*> (os::posix::open (name_, 0));
-      if (tty_ == nullptr)
+      if (transport_->open () == false)
         {
           err_no = tty_open;
           break;
         }
 
-      struct termios tio;
-      if (tty_->tcgetattr (&tio) < 0)
-        {
-          dacq::close ();
-          err_no = tty_attr;
-          break;
-        }
-      tio.c_cc[VTIME] = (rec_timeout / 100) & 0xFF;
-      tio.c_cc[VTIME_MS] = rec_timeout % 100;
-      tio.c_cc[VMIN] = 0;
-
-      // set baud rate, character size and parity, if any
-      tio.c_ospeed = tio.c_ispeed = baudrate;
-      tio.c_cflag = c_size | parity;
-
-      if (tty_->tcsetattr (TCSANOW, &tio) < 0)
+      // set baud rate, character size, parity and receive timeout
+      if (transport_->set_attributes (baudrate, c_size, parity, rec_timeout)
+          == false)
         {
           dacq::close ();
           err_no = tty_attr;
           break;
         }
+      baudrate_ = baudrate;
+      c_size_ = c_size;
+      parity_ = parity;
+      rec_timeout_ = rec_timeout;
 
       err_no = ok;
       result = true;
@@ -137,50 +146,65 @@ dacq::direct (int fildes, int timeout)
   int count;
   uint8_t buff[512];
 
-  console_ =
+#if DACQ_HOST == true
+  dacq_linux console
+    { fildes };
+#else
+  os::posix::tty* tty =
       static_cast<os::posix::tty*> (os::posix::file_descriptors_manager::io (
           fildes));
 
   // set a timeout on input
   struct termios tio_save;
   struct termios tio;
-  console_->tcgetattr (&tio_save);
-  console_->tcgetattr (&tio);
+  tty->tcgetattr (&tio_save);
+  tty->tcgetattr (&tio);
   tio.c_cc[VTIME] = 100;
   tio.c_cc[VMIN] = 0;
-  console_->tcsetattr (TCSANOW, &tio);
-
-  thread::attributes attr;
-  attr.th_stack_size_bytes = 2048;
-
-  thread th_dacq_rcv
-    { "dacq-receive", dacq_rcv, static_cast<void*> (this), attr };
-
-  int timeout_cnt = timeout / 10;
-
-  while (timeout_cnt--)
-    {
-      while ((count = console_->read (buff, sizeof(buff))) > 0)
-        {
-          timeout_cnt = timeout / 20;
-          if (count <= 3 && buff[0] == 0x18) // ctrl-X
-            {
-              count = -1;
-              break;  // terminate direct command
-            }
-          if ((count = tty_->write (buff, count)) < 0)
-            {
-              break;
-            }
-        }
-      if (count < 0)
-        {
-          break;        // tty error, exit
-        }
-    }
-
+  tty->tcsetattr (TCSANOW, &tio);
+
+  dacq_tty console
+    { tty };
+#endif
+  console_ = &console;
+
+  {
+    // the receive thread ends with this block, before the console
+    thread::attributes attr;
+    attr.th_stack_size_bytes = 2048;
+
+    thread th_dacq_rcv
+      { "dacq-receive", dacq_rcv, static_cast<void*> (this), attr };
+
+    int timeout_cnt = timeout / 10;
+
+    while (timeout_cnt--)
+      {
+        while ((count = console_->read (buff, sizeof(buff), 10000)) > 0)
+          {
+            timeout_cnt = timeout / 20;
+            if (count <= 3 && buff[0] == 0x18) // ctrl-X
+              {
+                count = -1;
+                break;  // terminate direct command
+              }
+            if ((count = transport_->write (buff, count)) < 0)
+              {
+                break;
+              }
+          }
+        if (count < 0)
+          {
+            break;        // tty error, exit
+          }
+      }
+  }
+  console_ = nullptr;           // the console is about to go out of scope
+
+#if DACQ_HOST == false
   // restore original termios
-  console_->tcsetattr (TCSANOW, &tio_save);
+  tty->tcsetattr (TCSANOW, &tio_save);
+#endif
 }
 
 /**
@@ -189,8 +213,7 @@ dacq::direct (int fildes, int timeout)
 void
 dacq::close (void)
 {
-  tty_->close ();
-  tty_ = nullptr;
+  transport_->close ();
 }
 
 //----------------------------------------------------------------------
@@ -209,7 +232,7 @@ dacq::dacq_rcv (void* args)
 
   do
     {
-      if ((count = pdacq->tty_->read (buff, sizeof(buff))) > 0)
+      if ((count = pdacq->transport_->read (buff, sizeof(buff))) > 0)
         {
           if (pdacq->console_->write (buff, count) < 0)
             {
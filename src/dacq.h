@@ -31,10 +31,14 @@
 #define DACQ_H_
 
 #include <cmsis-plus/rtos/os.h>
-#include <cmsis-plus/posix/termios.h>
 
-#include "uart-drv.h"
 #include "dacq-config.h"
+#include "dacq-transport.h"
+#if DACQ_HOST == true
+#include "dacq-linux.h"
+#else
+#include "dacq-tty.h"
+#endif
 
 #if defined (__cplusplus)
 
@@ -44,6 +48,8 @@ public:
 
   dacq (const char* name);
 
+  dacq (dacq_transport& transport);
+
   virtual
   ~dacq ();
 
@@ -52,11 +58,13 @@ public:
     time_t date;        // date/time stamp for this data set
     float* data;        // pointer on an array of tags
     uint8_t* status;    // pointer on an array of tag statuses
-    uint8_t data_count; // number of expected/returned values (tags)
+    uint16_t data_count; // number of expected/returned values (tags)
     void* impl;         // pointer to a struct, implementation specific
     bool
     (*cb) (void*);      // user call-back function to handle data
     void* cb_parameter; // pointer on a custom parameter (eg for the call-back)
+    uint64_t ready;     // when the measurement completed, in µs (returned)
+    uint64_t received;  // when the data was received, in µs (returned)
   } dacq_handle_t;
 
   /**
@@ -219,6 +227,9 @@ public:
     set_acq_interval_failed,
     initialisation_required,
     sensor_too_slow,
+    invalid_address,
+    no_memory,
+    completion_busy,
 
     //
     last
@@ -235,8 +246,14 @@ public:
 
 protected:
 
-  os::posix::tty* tty_;
-  os::posix::tty* console_;
+  dacq_transport* transport_;
+  dacq_transport* console_ = nullptr;   // set during direct() only
+  // port attributes given to open(), e.g. to restore them after a
+  // temporary change
+  speed_t baudrate_ = 0;
+  uint32_t c_size_ = 0;
+  uint32_t parity_ = 0;
+  uint32_t rec_timeout_ = 0;
   os::rtos::mutex mutex_
     { "dacq_mx" };
   void
@@ -270,6 +287,9 @@ protected:
       { set_acq_interval_failed, "failed to set the acquisition interval" },
       { initialisation_required, "sensor/logger requires initialisation" },
       { sensor_too_slow, "sensor needs too much time to measure" },
+      { invalid_address, "invalid sensor address" },
+      { no_memory, "not enough memory" },
+      { completion_busy, "completion handle still armed" },
 
     };
 
@@ -278,7 +298,12 @@ private:
   static void*
   dacq_rcv (void* args);
 
-  const char* name_;
+  // the transport used when the class is constructed with a device name
+#if DACQ_HOST == true
+  dacq_linux default_transport_;
+#else
+  dacq_tty default_transport_;
+#endif
 
 };
 
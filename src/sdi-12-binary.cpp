@@ -0,0 +1,153 @@
+/*
+ * sdi-12-binary.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#include <string.h>
+#include "sdi-12-binary.h"
+#include "sdi-12-crc.h"
+
+/**
+ * @brief Return the size in bytes of a value of the given type.
+ * @return the size, or 0 if the type is not valid.
+ */
+size_t
+sdi12_binary::type_size (type_t type)
+{
+  static const uint8_t sizes[types] =
+    { 0, 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+
+  return type < types ? sizes[type] : 0;
+}
+
+/**
+ * @brief Convert a value received least significant byte first.
+ * @param bytes: the bytes of the value.
+ * @param type: the data type; it must be valid.
+ * @return the value.
+ */
+float
+sdi12_binary::to_float (const uint8_t* bytes, type_t type)
+{
+  uint64_t v = 0;
+
+  for (size_t i = type_size (type); i > 0; i--)
+    {
+      v = (v << 8) | bytes[i - 1];
+    }
+
+  switch (type)
+    {
+    case int8:
+      return (int8_t) v;
+    case uint8:
+      return (uint8_t) v;
+    case int16:
+      return (int16_t) v;
+    case uint16:
+      return (uint16_t) v;
+    case int32:
+      return (int32_t) v;
+    case uint32:
+      return (uint32_t) v;
+    case int64:
+      return (int64_t) v;
+    case uint64:
+      return v;
+    case float32:
+      {
+        uint32_t bits = (uint32_t) v;
+        float f;
+        memcpy (&f, &bits, sizeof(f));
+        return f;
+      }
+    case float64:
+      {
+        double d;
+        memcpy (&d, &v, sizeof(d));
+        return d;
+      }
+    default:
+      return 0;
+    }
+}
+
+/**
+ * @brief Account for received bytes: the header and the payload are added
+ *      to the CRC, and each value is stored as soon as it is complete.
+ * @param bytes: the received bytes.
+ * @param count: number of bytes; bytes beyond the end of the packet are
+ *      ignored, as are all the bytes after a header with a payload size
+ *      larger than max_payload.
+ * @return true if the packet is now complete (or rejected), false
+ *      otherwise.
+ */
+bool
+sdi12_binary::put (const uint8_t* bytes, size_t count)
+{
+  for (size_t i = 0; i < count && complete () == false; i++)
+    {
+      uint8_t b = bytes[i];
+
+      if (pos_ < header_size)
+        {
+          header_[pos_++] = b;
+          crc_ = sdi12_crc::update (crc_, b);
+          if (pos_ == header_size)
+            {
+              element_ = type_size (type ());
+              if (element_ != 0 && size () % element_ != 0)
+                {
+                  element_ = 0;         // not whole values
+                }
+            }
+        }
+      else if (pos_ < header_size + size ())
+        {
+          pos_++;
+          crc_ = sdi12_crc::update (crc_, b);
+          if (element_ != 0)
+            {
+              value_[fill_++] = b;
+              if (fill_ == element_)
+                {
+                  fill_ = 0;
+                  if (count_ < room_)
+                    {
+                      data_[count_++] = to_float (value_, type ());
+                    }
+                }
+            }
+        }
+      else
+        {
+          rx_crc_ |= b << (8 * (pos_++ - header_size - size ()));
+        }
+    }
+
+  return complete ();
+}
@@ -0,0 +1,233 @@
+/*
+ * sdi-12-binary.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_BINARY_H_
+#define SDI_12_BINARY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined (__cplusplus)
+
+/*
+ * Incremental decoder for the binary packets returned by the SDI-12 1.4
+ * "DB" commands (after a high volume binary measurement, "HB"). A packet
+ * consists of the sensor address, the payload size in bytes (two bytes,
+ * least significant first), the data type, the payload and a binary CRC
+ * (two bytes, least significant first) computed on all the preceding
+ * bytes. The payload holds values of the given type, least significant
+ * byte first. The bytes are fed to put() as they are received; the CRC is
+ * updated on the fly and each value is converted to float and stored as
+ * soon as its last byte arrived, so the packet is never staged as a whole.
+ * An empty payload ends the data of a measurement; a payload size larger
+ * than max_payload can only be corrupt, the packet then ends with its
+ * header and is neither valid nor checked.
+ */
+class sdi12_binary
+{
+public:
+
+  typedef enum
+  {
+    invalid = 0,
+    int8,
+    uint8,
+    int16,
+    uint16,
+    int32,
+    uint32,
+    int64,
+    uint64,
+    float32,
+    float64,
+    types
+  } type_t;
+
+  // address, payload size and data type
+  static constexpr size_t header_size = 4;
+  static constexpr size_t crc_size = 2;
+  static constexpr size_t max_payload = 1000;
+
+  void
+  begin (float* data, size_t room);
+
+  void
+  reset (void);
+
+  size_t
+  wanted (void);
+
+  bool
+  put (const uint8_t* bytes, size_t count);
+
+  bool
+  complete (void);
+
+  bool
+  valid (void);
+
+  bool
+  crc_valid (void);
+
+  char
+  address (void);
+
+  uint16_t
+  size (void);
+
+  type_t
+  type (void);
+
+  uint16_t
+  count (void);
+
+  const uint8_t*
+  header (void);
+
+  static size_t
+  type_size (type_t type);
+
+  static float
+  to_float (const uint8_t* bytes, type_t type);
+
+private:
+
+  float* data_ = nullptr;
+  size_t room_ = 0;     // values that fit in data_
+  uint8_t header_[header_size];
+  uint8_t value_[8];    // bytes of the value being received
+  size_t pos_ = 0;      // bytes of the packet received so far
+  size_t fill_ = 0;     // bytes of the value being received
+  size_t element_ = 0;  // size of a value, 0 if the type is not valid
+  uint16_t crc_ = 0;    // computed CRC
+  uint16_t rx_crc_ = 0; // received CRC
+  uint16_t count_ = 0;  // values stored
+
+};
+
+/**
+ * @brief Set where the values of the next packet are stored, and prepare
+ *      for its first byte.
+ * @param data: array where the values are returned.
+ * @param room: number of values that fit in the array; further values are
+ *      checked, but not stored.
+ */
+inline void
+sdi12_binary::begin (float* data, size_t room)
+{
+  data_ = data;
+  room_ = room;
+  reset ();
+}
+
+/**
+ * @brief Discard the bytes received so far; the values already stored are
+ *      overwritten by the next packet.
+ */
+inline void
+sdi12_binary::reset (void)
+{
+  pos_ = fill_ = element_ = 0;
+  crc_ = rx_crc_ = count_ = 0;
+}
+
+/**
+ * @brief Return how many bytes are still missing: the rest of the header,
+ *      or, once the header was received, the rest of the packet (none if
+ *      the payload size is not valid).
+ */
+inline size_t
+sdi12_binary::wanted (void)
+{
+  return pos_ < header_size ? header_size - pos_ :
+         size () > max_payload ? 0 : header_size + size () + crc_size - pos_;
+}
+
+inline bool
+sdi12_binary::complete (void)
+{
+  return pos_ >= header_size && wanted () == 0;
+}
+
+/**
+ * @brief Check if the payload size is valid, the data type known and the
+ *      payload made of whole values; an empty packet is always valid.
+ */
+inline bool
+sdi12_binary::valid (void)
+{
+  return pos_ >= header_size && size () <= max_payload
+      && (size () == 0 || element_ != 0);
+}
+
+inline bool
+sdi12_binary::crc_valid (void)
+{
+  return complete () && size () <= max_payload && rx_crc_ == crc_;
+}
+
+inline char
+sdi12_binary::address (void)
+{
+  return pos_ > 0 ? header_[0] : 0;
+}
+
+/**
+ * @brief Return the payload size in bytes, 0 until the header was received.
+ */
+inline uint16_t
+sdi12_binary::size (void)
+{
+  return pos_ >= header_size ? header_[1] | (header_[2] << 8) : 0;
+}
+
+inline sdi12_binary::type_t
+sdi12_binary::type (void)
+{
+  return pos_ >= header_size ? (type_t) header_[3] : invalid;
+}
+
+/**
+ * @brief Return the number of values stored so far.
+ */
+inline uint16_t
+sdi12_binary::count (void)
+{
+  return count_;
+}
+
+inline const uint8_t*
+sdi12_binary::header (void)
+{
+  return header_;
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* SDI_12_BINARY_H_ */
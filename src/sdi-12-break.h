@@ -0,0 +1,80 @@
+/*
+ * sdi-12-break.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_BREAK_H_
+#define SDI_12_BREAK_H_
+
+#include <cmsis-plus/rtos/os.h>
+
+#ifndef SDI_MARKING_TIMEOUT
+#define SDI_MARKING_TIMEOUT 87  // milliseconds
+#endif
+
+#if defined (__cplusplus)
+
+/*
+ * Decides when a break must precede an SDI-12 command. According to the
+ * SDI-12 specification, a break is required only if the line has been
+ * marking for more than 87 ms, as the sensors might have returned to the
+ * low-power standby state; commands to different addresses issued back to
+ * back do not need a break. Derive from this class to implement other
+ * policies and install them with sdi12_dr::set_break_policy().
+ */
+class sdi12_break_policy
+{
+public:
+
+  virtual
+  ~sdi12_break_policy () = default;
+
+  virtual bool
+  need_break (char addr, char last_addr, os::rtos::clock::duration_t idle,
+              bool strict);
+
+};
+
+/**
+ * @brief Decide whether a break must be sent before the next command.
+ * @param addr: address of the sensor the command is addressed to.
+ * @param last_addr: address of the sensor of the previous transaction.
+ * @param idle: for how long the line has been marking, in ms.
+ * @param strict: if true, the sensor also requires a break whenever the
+ *      address changes (sensors with flawed implementations).
+ * @return true if a break must be sent, false otherwise.
+ */
+inline bool
+sdi12_break_policy::need_break (char addr, char last_addr,
+                                os::rtos::clock::duration_t idle, bool strict)
+{
+  return idle > SDI_MARKING_TIMEOUT || (strict && addr != last_addr);
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* SDI_12_BREAK_H_ */
@@ -0,0 +1,53 @@
+/*
+ * sdi-12-crc.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#include "sdi-12-crc.h"
+
+// the constructors are constexpr, hence the tables are computed by the
+// compiler and placed in read-only memory
+const sdi12_crc::table_t<16, 4> sdi12_crc::nibble_table_;
+const sdi12_crc::table_t<256, 8> sdi12_crc::byte_table_;
+
+/**
+ * @brief Compute the CRC of an SDI-12 string.
+ * @param initial: initial CRC value (normally 0).
+ * @param buff: buffer containing the SDI-12 string.
+ * @param len: length of the SDI-12 string.
+ * @return Computed CRC value for the SDI-12 string.
+ */
+uint16_t
+sdi12_crc::compute (uint16_t initial, const uint8_t* buff, size_t len)
+{
+  while (len--)
+    {
+      initial = update (initial, *buff++);
+    }
+
+  return initial;
+}
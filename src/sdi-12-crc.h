@@ -0,0 +1,169 @@
+/*
+ * sdi-12-crc.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_CRC_H_
+#define SDI_12_CRC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 0: bit by bit, 1: 16 entries table (32 bytes), 2: 256 entries table
+// (512 bytes)
+#ifndef SDI_CRC_TABLE
+#define SDI_CRC_TABLE 2
+#endif
+
+#if defined (__cplusplus)
+
+/*
+ * The SDI-12 CRC-16 (polynomial 0xA001, reflected, initial value 0). The
+ * lookup tables are generated at compile time; the engine used by the
+ * driver is selected with SDI_CRC_TABLE, the other engines are available
+ * for testing and benchmarking (with --gc-sections, unused tables do not
+ * end up in flash).
+ */
+class sdi12_crc
+{
+public:
+
+  static uint16_t
+  update (uint16_t crc, uint8_t byte);
+
+  static uint16_t
+  compute (uint16_t initial, const uint8_t* buff, size_t len);
+
+  static void
+  to_ascii (uint16_t crc, char* ascii);
+
+  static uint16_t
+  from_ascii (const char* ascii);
+
+  static uint16_t
+  update_bitwise (uint16_t crc, uint8_t byte);
+
+  static uint16_t
+  update_nibble (uint16_t crc, uint8_t byte);
+
+  static uint16_t
+  update_table (uint16_t crc, uint8_t byte);
+
+private:
+
+  static constexpr uint16_t polynomial = 0xA001;
+
+  template<size_t N, int bits>
+    struct table_t
+    {
+      constexpr
+      table_t () :
+          entry ()
+      {
+        for (size_t i = 0; i < N; i++)
+          {
+            uint16_t crc = i;
+            for (int b = 0; b < bits; b++)
+              {
+                crc = (crc & 1) ? (crc >> 1) ^ polynomial : crc >> 1;
+              }
+            entry[i] = crc;
+          }
+      }
+
+      uint16_t entry[N];
+    };
+
+  static const table_t<16, 4> nibble_table_;
+  static const table_t<256, 8> byte_table_;
+
+};
+
+/**
+ * @brief Add a byte to a running CRC, using the selected engine.
+ */
+inline uint16_t
+sdi12_crc::update (uint16_t crc, uint8_t byte)
+{
+#if SDI_CRC_TABLE == 2
+  return update_table (crc, byte);
+#elif SDI_CRC_TABLE == 1
+  return update_nibble (crc, byte);
+#else
+  return update_bitwise (crc, byte);
+#endif
+}
+
+inline uint16_t
+sdi12_crc::update_bitwise (uint16_t crc, uint8_t byte)
+{
+  crc ^= byte;
+  for (int i = 0; i < 8; i++)
+    {
+      crc = (crc & 1) ? (crc >> 1) ^ polynomial : crc >> 1;
+    }
+
+  return crc;
+}
+
+inline uint16_t
+sdi12_crc::update_nibble (uint16_t crc, uint8_t byte)
+{
+  crc = (crc >> 4) ^ nibble_table_.entry[(crc ^ byte) & 0xF];
+  return (crc >> 4) ^ nibble_table_.entry[(crc ^ (byte >> 4)) & 0xF];
+}
+
+inline uint16_t
+sdi12_crc::update_table (uint16_t crc, uint8_t byte)
+{
+  return (crc >> 8) ^ byte_table_.entry[(crc ^ byte) & 0xFF];
+}
+
+/**
+ * @brief Encode a CRC as the three ASCII characters sent on the bus.
+ */
+inline void
+sdi12_crc::to_ascii (uint16_t crc, char* ascii)
+{
+  ascii[0] = 0x40 | (crc >> 12);
+  ascii[1] = 0x40 | ((crc >> 6) & 0x3F);
+  ascii[2] = 0x40 | (crc & 0x3F);
+}
+
+/**
+ * @brief Decode the three ASCII characters of a CRC.
+ */
+inline uint16_t
+sdi12_crc::from_ascii (const char* ascii)
+{
+  return ((ascii[0] & 0x3F) << 12) | ((ascii[1] & 0x3F) << 6)
+      | (ascii[2] & 0x3F);
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* SDI_12_CRC_H_ */
@@ -32,11 +32,14 @@
  * data recorder.
  */
 
+#include <stdio.h>
 #include <inttypes.h>
+#include <new>
 #include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 
 #include "sdi-12-dr.h"
+#include "sdi-12-parser.h"
 
 #define SDI_DEBUG false
 
@@ -54,12 +57,79 @@ sdi12_dr::sdi12_dr (const char* name) :
   trace::printf ("%s() %p\n", __func__, this);
 }
 
+/**
+ * @brief Constructor for a specific transport (e.g. a simulated bus).
+ * @param transport: the transport to use.
+ */
+sdi12_dr::sdi12_dr (dacq_transport& transport) :
+    dacq
+      { transport }
+{
+  trace::printf ("%s() %p\n", __func__, this);
+}
+
 /**
  * @brief Destructor.
  */
 sdi12_dr::~sdi12_dr ()
 {
   trace::printf ("%s() %p\n", __func__, this);
+#if MAX_CONCURRENT_REQUESTS > 0
+  delete[] pool_msgs_;
+  delete[] pool_items_;
+#endif
+}
+
+/**
+ * @brief Install the time source used for all timestamps, sleeps and timed
+ *      waits of the driver, e.g. a dacq_virtual_clock to run on a simulated
+ *      bus faster than real time. Call it while the driver is idle.
+ * @param clock: pointer to the clock; if nullptr, the system clock is
+ *      restored.
+ */
+void
+sdi12_dr::set_clock (dacq_clock* clock)
+{
+  clock = clock ? clock : &default_clock_;
+  // keep the wall clock mapping
+  wall_offset_us_ += (int64_t) clock_->now_us () - (int64_t) clock->now_us ();
+#if MAX_CONCURRENT_REQUESTS > 0
+  // the collect thread is a user of the clock too; wake it up, so that it
+  // waits on the new clock
+  clock->attach ();
+  clock_->detach ();
+  clock_ = clock;
+  sem_.post ();
+#else
+  clock_ = clock;
+#endif
+}
+
+/**
+ * @brief Set the wall clock, used for the timestamps of the data (the ready,
+ *      received and date members of the handles). The timestamps are taken
+ *      from the bus timing and mapped to the wall clock when they are
+ *      recorded, so they do not depend on when the call-back runs. Call it
+ *      again to correct the drift of the clock, e.g. after synchronising the
+ *      RTC; until it is called, the timestamps count from the start of the
+ *      clock.
+ * @param date: current date/time.
+ * @return true.
+ */
+bool
+sdi12_dr::set_date (time_t date)
+{
+  wall_offset_us_ = (int64_t) date * 1000000 - (int64_t) clock_->now_us ();
+  return true;
+}
+
+/**
+ * @brief Return the current date/time of the wall clock (see set_date()).
+ */
+time_t
+sdi12_dr::get_date (void)
+{
+  return wall_us (clock_->now_us ()) / 1000000;
 }
 
 /**
@@ -74,13 +144,14 @@ bool
 sdi12_dr::get_info (int id, char* info, size_t len)
 {
   bool result = false;
-  int retries = retries_with_break;
+  int retries;
 
   if (len > 36)
     {
-      if (mutex_.timed_lock (lock_timeout) == result::ok)
+      if (clock_->timed_lock (mutex_, lock_timeout) == result::ok)
         {
-          origin_ = sysclock.now ();
+          origin_ = clock_->now ();
+          retries = rounds (id);
           do
             {
               info[0] = id;
@@ -108,6 +179,7 @@ sdi12_dr::get_info (int id, char* info, size_t len)
               force_break ();
             }
           while (--retries);
+          flush_dump ();
           mutex_.unlock ();
         }
       else
@@ -128,6 +200,284 @@ sdi12_dr::get_info (int id, char* info, size_t len)
   return result;
 }
 
+/**
+ * @brief Learn a measurement of a sensor with the SDI-12 1.4 metadata
+ *      commands and store it in the schema cache (see set_schema()): the
+ *      identification of the sensor (aI!) is checked against the cache,
+ *      and only if the measurement is not known for this sensor, the
+ *      number of values and the measurement time are queried (e.g. with
+ *      aIM! for "M" measurements). Once learned, find() of the cache
+ *      returns them, e.g. to size the data arrays.
+ * @param sdi: a sdi12_t type structure defining the sensor and the
+ *      measurement.
+ * @return true if successful, false otherwise.
+ */
+bool
+sdi12_dr::learn (sdi12_t* sdi)
+{
+  bool result = false;
+  char buff[48];
+  int count;
+  uint32_t identity = 0;
+
+  if (schema_ == nullptr)
+    {
+      error = &err_[no_memory]; // nowhere to store what was learned
+      return false;
+    }
+  if (sdi->index >= 10)
+    {
+      error = &err_[invalid_index];
+      return false;
+    }
+
+  if (clock_->timed_lock (mutex_, lock_timeout) == result::ok)
+    {
+      origin_ = clock_->now ();
+      int retries = rounds (sdi->addr);
+      do
+        {
+          buff[0] = sdi->addr;
+          buff[1] = 'I';
+          buff[2] = '!';
+          if ((count = transaction (buff, 3, sizeof(buff), sdi->strict_break))
+              > 0)
+            {
+              if (buff[0] != sdi->addr)
+                {
+                  error = &err_[unexpected_answer];
+                  tally (sdi->addr, sdi12_stats::unexpected);
+                }
+              else
+                {
+                  identity = sdi12_schema::identity (buff + 1);
+                  result = true;
+                  break;
+                }
+            }
+          force_break ();
+        }
+      while (--retries);
+
+      sdi12_schema::entry_t entry;
+      if (result == true
+          && (schema_->check (sdi->addr, identity) == false
+              || schema_->find (sdi->addr, sdi->method, sdi->index, entry)
+                  == false))
+        {
+          // not known yet, or another sensor answers at this address
+          result = false;
+          retries = rounds (sdi->addr);
+          do
+            {
+              buff[0] = sdi->addr;
+              buff[1] = 'I';
+              size_t len = 2 + measurement_command (sdi, buff + 2);
+              buff[len++] = '!';
+              if ((count = transaction (buff, len, sizeof(buff),
+                                        sdi->strict_break)) > 0)
+                {
+                  if (measurement_answer (buff, count, sdi->addr, entry.ttt,
+                                          entry.values) == false)
+                    {
+                      error = &err_[unexpected_answer];
+                      tally (sdi->addr, sdi12_stats::unexpected);
+                    }
+                  else
+                    {
+                      entry.addr = sdi->addr;
+                      entry.method = sdi->method;
+                      entry.index = sdi->index;
+                      entry.identity = identity;
+                      result = schema_->store (entry);
+                      error = &err_[result ? ok : no_memory];
+                      break;
+                    }
+                }
+              force_break ();
+            }
+          while (--retries);
+        }
+      flush_dump ();
+      mutex_.unlock ();
+    }
+  else
+    {
+      error = &err_[dacq_busy];
+    }
+
+  return result;
+}
+
+/**
+ * @brief Get the description of a value of a measurement with the SDI-12
+ *      1.4 parameter metadata commands (e.g. aIM_001!).
+ * @param sdi: a sdi12_t type structure defining the sensor and the
+ *      measurement.
+ * @param param: parameter (value) number, from 1 to 999.
+ * @param text: buffer where the description is returned, as sent by the
+ *      sensor without address, CRC and final ';', e.g. "RP,mm".
+ * @param len: length of the buffer; longer descriptions are truncated.
+ * @return true if successful, false otherwise (also if the sensor does not
+ *      describe the parameter).
+ */
+bool
+sdi12_dr::get_parameter (sdi12_t* sdi, uint16_t param, char* text,
+                         size_t len)
+{
+  bool result = false;
+  char buff[longest_sdi12_frame];
+  int count;
+  int retries;
+
+  if (len == 0 || param == 0 || param > 999 || sdi->index >= 10)
+    {
+      error = &err_[len ? invalid_index : buffer_too_small];
+      return false;
+    }
+
+  if (clock_->timed_lock (mutex_, lock_timeout) == result::ok)
+    {
+      origin_ = clock_->now ();
+      retries = rounds (sdi->addr);
+      do
+        {
+          buff[0] = sdi->addr;
+          buff[1] = 'I';
+          size_t n = 2 + measurement_command (sdi, buff + 2);
+          buff[n++] = '_';
+          buff[n++] = param / 100 + '0';
+          buff[n++] = param / 10 % 10 + '0';
+          buff[n++] = param % 10 + '0';
+          buff[n++] = '!';
+          if ((count = transaction (buff, n, sizeof(buff), sdi->strict_break))
+              > 0)
+            {
+              if (sdi->addr != buff[0])
+                {
+                  error = &err_[unexpected_answer];
+                  tally (sdi->addr, sdi12_stats::unexpected);
+                }
+              else if (sdi->use_crc && rx_frame_.crc_valid () == false)
+                {
+                  error = &err_[crc_error];
+                  tally (sdi->addr, sdi12_stats::crc_errors);
+                }
+              else
+                {
+                  // "a,<parameter>;", the sensor answers "a" if there is
+                  // no such parameter
+                  int end = count - (sdi->use_crc ? 5 : 2);
+                  if (end >= 3 && buff[1] == ',' && buff[end - 1] == ';')
+                    {
+                      n = std::min ((size_t) (end - 3), len - 1);
+                      memcpy (text, buff + 2, n);
+                      text[n] = '\0';
+                      result = true;
+                    }
+                  else
+                    {
+                      error = &err_[no_sensor_data];
+                    }
+                  break;
+                }
+            }
+          force_break ();
+        }
+      while (--retries);
+      flush_dump ();
+      mutex_.unlock ();
+    }
+  else
+    {
+      error = &err_[dacq_busy];
+    }
+
+  return result;
+}
+
+/**
+ * @brief Find the sensors present on the bus. Every address is probed once
+ *      with the acknowledge command and a short timeout (SDI_PROBE_TIMEOUT),
+ *      absent addresses are not retried; only the addresses that answered
+ *      are then verified with a normal transaction, including retries.
+ * @param found: bitmap of the sensors found, the bit number being the
+ *      address index (see addr_to_index()).
+ * @param single: if true, first query the address with the wildcard "?!"
+ *      command, which is only valid if a single sensor is on the bus; if the
+ *      answer is garbled (more sensors answered) or missing, the bus is
+ *      scanned anyway.
+ * @return true if the bus was scanned, false otherwise.
+ */
+bool
+sdi12_dr::discover (uint64_t& found, bool single)
+{
+  bool result = false;
+  char buff[8];
+  int index;
+
+  found = 0;
+  if (clock_->timed_lock (mutex_, lock_timeout) == result::ok)
+    {
+      origin_ = clock_->now ();
+      result = true;
+      if (single == true)
+        {
+          buff[0] = '?';
+          buff[1] = '!';
+          if (transaction (buff, 2, sizeof(buff)) == 3
+              && (index = addr_to_index (buff[0])) >= 0
+              && probe (buff[0]) == true)
+            {
+              found = 1ULL << index;
+            }
+        }
+
+      if (found == 0)
+        {
+          // first pass: one short probe per address
+          uint64_t candidates = 0;
+          for (index = 0; index < max_addresses; index++)
+            {
+              if (probe (index_to_addr (index)) == true)
+                {
+                  candidates |= 1ULL << index;
+                }
+              else if (error == &err_[tty_error])
+                {
+                  result = false;
+                  break;
+                }
+            }
+
+          // second pass: verify the positives only
+          for (index = 0; result == true && index < max_addresses; index++)
+            {
+              if ((candidates & (1ULL << index)) == 0)
+                {
+                  continue;
+                }
+              buff[0] = index_to_addr (index);
+              buff[1] = '!';
+              if (transaction (buff, 2, sizeof(buff)) == 3
+                  && buff[0] == index_to_addr (index))
+                {
+                  found |= 1ULL << index;
+                }
+            }
+        }
+      error = &err_[result == true ? ok : tty_error];
+      flush_dump ();
+      mutex_.unlock ();
+    }
+  else
+    {
+      error = &err_[dacq_busy];
+    }
+
+  return result;
+}
+
 /**
  * @brief Change sensor address (id).
  * @param id: sensor address to change.
@@ -139,11 +489,12 @@ sdi12_dr::change_id (int id, int new_id)
 {
   bool result = false;
   char buffer[8];
-  int retries = retries_with_break;
+  int retries;
 
-  if (mutex_.timed_lock (lock_timeout) == result::ok)
+  if (clock_->timed_lock (mutex_, lock_timeout) == result::ok)
     {
-      origin_ = sysclock.now ();
+      origin_ = clock_->now ();
+      retries = rounds (id);
       do
         {
           buffer[0] = id;
@@ -166,6 +517,7 @@ sdi12_dr::change_id (int id, int new_id)
           force_break ();
         }
       while (--retries);
+      flush_dump ();
       mutex_.unlock ();
     }
   else
@@ -188,14 +540,15 @@ bool
 sdi12_dr::transparent (char* xfer_buff, int& len)
 {
   bool result = false;
-  int retries = retries_with_break;
+  int retries;
   char buff[longest_sdi12_frame];
   size_t in_len = std::min (len, longest_sdi12_frame);
 
-  if (mutex_.timed_lock (lock_timeout) == result::ok)
+  if (clock_->timed_lock (mutex_, lock_timeout) == result::ok)
     {
       memcpy (buff, xfer_buff, in_len);
-      origin_ = sysclock.now ();
+      origin_ = clock_->now ();
+      retries = rounds (xfer_buff[0]);
       do
         {
           if ((len = transaction (xfer_buff, strlen (xfer_buff), len)) > 0)
@@ -211,6 +564,7 @@ sdi12_dr::transparent (char* xfer_buff, int& len)
           force_break ();
         }
       while (--retries);
+      flush_dump ();
       mutex_.unlock ();
     }
   else
@@ -231,91 +585,168 @@ bool
 sdi12_dr::retrieve (dacq_handle_t* dacqh)
 {
   bool result = false;
-  int waiting_time;
-  uint8_t measurements = 0;
-  sdi12_t* sdi = (sdi12_t*) dacqh->impl;
 
-  if (mutex_.timed_lock (lock_timeout) == result::ok)
+  if (clock_->timed_lock (mutex_, lock_timeout) == result::ok)
     {
-      do
+      // set default for all status bits to "missing"
+      if (dacqh->status != nullptr)
         {
-          // set default for all status bits to "missing"
           memset (dacqh->status, STATUS_BIT_MISSING, dacqh->data_count);
-          origin_ = sysclock.now ();
+        }
+      origin_ = clock_->now ();
 
-          if (sdi->method != sdi12_dr::continuous)
-            {
 #if MAX_CONCURRENT_REQUESTS > 0
-              if (sdi->method == sdi12_dr::concurrent)
+      if (((sdi12_t*) dacqh->impl)->method == sdi12_dr::concurrent)
+        {
+          // we initiate a real concurrent retrieve (SDI-12 command C), the
+          // data is delivered by the call-back
+          result = retrieve_concurrent (dacqh);
+        }
+      else
+#endif
+        {
+          result = retrieve_sequential (dacqh);
+          dispatch (dacqh);
+        }
+      flush_dump ();
+      mutex_.unlock ();
+    }
+  else
+    {
+      error = &err_[dacq_busy];
+    }
+
+  return result;
+}
+
+/**
+ * @brief Retrieve data from several sensors in one sweep. Instead of
+ *      executing the requests in the given order, the sweep is planned to
+ *      keep the bus busy: all the concurrent measurements ("C") are started
+ *      back to back, the sequential measurements ("M", "V", "R") are
+ *      executed while the concurrent sensors measure, and the data of the
+ *      concurrent sensors is collected in the order they become ready. If
+ *      there are more concurrent requests than free entries in the request
+ *      table, the remaining ones are started as soon as entries are freed.
+ *      The bus is locked for the whole sweep; concurrent requests started
+ *      earlier with retrieve() are collected as well when they become ready.
+ * @param dacqh: array of pointers on dacq_handle_t structures, one for each
+ *      sensor; the call-backs are called as with retrieve().
+ * @param count: number of elements in the array.
+ * @return true if the data of all sensors was retrieved, false otherwise;
+ *      the error refers then to the last request that failed.
+ */
+bool
+sdi12_dr::retrieve_many (dacq_handle_t* dacqh[], size_t count)
+{
+  bool result = false;
+  const err_t* failed = &err_[ok];
+  size_t retrieved = 0;
+  size_t next_seq = 0;
+#if MAX_CONCURRENT_REQUESTS > 0
+  size_t next_conc = 0;
+  size_t outstanding = 0;
+  concurent_msg_t* pmsg;
+  clock::timestamp_t next = 0;
+#endif
+
+  if (clock_->timed_lock (mutex_, lock_timeout) == result::ok)
+    {
+      origin_ = clock_->now ();
+      while (true)
+        {
+#if MAX_CONCURRENT_REQUESTS > 0
+          // start all concurrent measurements back to back
+          while ((next_conc = next_request (dacqh, count, next_conc, true))
+              < count)
+            {
+              dacq_handle_t* dh = dacqh[next_conc];
+              if (dh->status != nullptr)
                 {
-                  // we initiate a real concurrent retrieve (SDI-12 command C)
-                  if (retrieve_concurrent (dacqh) == false)
-                    {
-                      break;
-                    }
+                  memset (dh->status, STATUS_BIT_MISSING, dh->data_count);
+                }
+              if (retrieve_concurrent (dh, true) == true)
+                {
+                  outstanding++;
+                }
+              else if (error->error_number != too_many_requests
+                  && error->error_number != sensor_busy)
+                {
+                  failed = error;
+                }
+              else if (requests_pending ())
+                {
+                  break;        // start it when an entry is freed
                 }
               else
-#endif
                 {
-                  // initiate a sequential retrieve
-                  if (start_measurement (sdi, waiting_time, measurements)
-                      == false)
-                    {
-                      break;
-                    }
-                  if (sdi->max_waiting > 0 && waiting_time > sdi->max_waiting)
+                  // no entry at all, measure sequentially
+                  if (retrieve_sequential (dh) == true)
                     {
-                      error = &err_[sensor_too_slow];
-                      break;    // we don't have time to wait so long
+                      retrieved++;
                     }
-                  // wait for the sensor to send a service request
-                  if (wait_for_service_request (sdi, waiting_time) == false)
+                  else
                     {
-                      break;
+                      failed = error;
                     }
+                  dispatch (dh);
                 }
+              next_conc++;
             }
 
-#if MAX_CONCURRENT_REQUESTS > 0
-          if (sdi->method != sdi12_dr::concurrent)
-#endif
+          // collect the data of the sensors that are ready
+          if ((pmsg = pop_ready (next)) != nullptr)
             {
-              measurements = std::min (dacqh->data_count, measurements);
-              if (measurements || sdi->method == sdi12_dr::continuous)
+              bool planned = pmsg->planned;
+              if (deliver (pmsg) == true)
                 {
-                  if (sdi->method != sdi12_dr::continuous)
-                    {
-                      sdi->method = sdi12_dr::data;
-                      sdi->index = 0;
-                    }
+                  retrieved += planned;
+                }
+              else if (planned)
+                {
+                  failed = error;
+                }
+              outstanding -= planned;
+              continue;
+            }
+#endif
 
-                  // get sensor data
-                  if (get_data (sdi, dacqh->data, dacqh->status, measurements)
-                      == false)
-                    {
-                      break;
-                    }
-                  error = &err_[ok];
-                  result = true;
+          // use the waiting time for a sequential measurement
+          if ((next_seq = next_request (dacqh, count, next_seq, false)) < count)
+            {
+              dacq_handle_t* dh = dacqh[next_seq++];
+              if (dh->status != nullptr)
+                {
+                  memset (dh->status, STATUS_BIT_MISSING, dh->data_count);
+                }
+              if (retrieve_sequential (dh) == true)
+                {
+                  retrieved++;
                 }
               else
                 {
-                  error = &err_[no_sensor_data];
+                  failed = error;
                 }
+              dispatch (dh);
+              flush_dump ();
+              continue;
             }
-        }
-      while (0);
 
 #if MAX_CONCURRENT_REQUESTS > 0
-      if (sdi->method != sdi12_dr::concurrent)
-#endif
-        {
-          dacqh->data_count = measurements;
-          if (dacqh->cb != nullptr)
+          // nothing else to do, wait for the next sensor to be ready
+          if (outstanding > 0 || next_conc < count)
             {
-              dacqh->cb (dacqh);
+              flush_dump ();
+              clock_->sleep_until (next);
+              continue;
             }
+#endif
+          break;
         }
+
+      result = retrieved == count;
+      error = failed;
+      flush_dump ();
       mutex_.unlock ();
     }
   else
@@ -326,102 +757,386 @@ sdi12_dr::retrieve (dacq_handle_t* dacqh)
   return result;
 }
 
-// --------------------------------------------------------------------------
-
-// --------------------------------------------------------------------------
-
 /**
- * @brief Perform an SDI-12 transaction using the RS-485 tty.
- * @param buff: buffer containing the SDI-12 request; on return, the buffer
- *      should contain the SDI-12 answer from the sensor.
- * @param cmd_len: command length.
- * @param len: buffer's total length.
- * @return: Number of characters returned, or -1 on error.
+ * @brief Retrieve data sequentially, i.e. wait for the sensor to measure;
+ *      the bus must be locked.
+ * @param dacqh: pointer on a structure of type dacq_handle_t containing all
+ *      sensor relevant data.
+ * @return true if successful, false otherwise.
  */
-int
-sdi12_dr::transaction (char* buff, size_t cmd_len, size_t len)
+bool
+sdi12_dr::retrieve_sequential (dacq_handle_t* dacqh)
 {
-  int result = 0;
-  err_num_t err_no = timeout;
-  char answer[longest_sdi12_frame];
-  int first;
+  bool result = false;
+  int waiting_time;
+  uint16_t measurements = 0;
+  sdi12_t* sdi = (sdi12_t*) dacqh->impl;
+  // high volume measurements return their values in up to 1000 pages
+  uint16_t pages = sdi->method == sdi12_dr::high_volume_ascii ? 1000 : 10;
+  bool binary = sdi->method == sdi12_dr::high_volume_binary;
+
+  do
+    {
+      if (sdi->method != sdi12_dr::continuous)
+        {
+          // initiate a sequential retrieve
+          if (start_measurement (sdi, waiting_time, measurements) == false)
+            {
+              break;
+            }
+          if (sdi->max_waiting > 0 && waiting_time > sdi->max_waiting)
+            {
+              error = &err_[sensor_too_slow];
+              break;    // we don't have time to wait so long
+            }
+          // wait for the sensor to send a service request
+          if (wait_for_service_request (sdi, waiting_time) == false)
+            {
+              break;
+            }
+        }
+
+      measurements = std::min (dacqh->data_count, measurements);
+      if (measurements || sdi->method == sdi12_dr::continuous)
+        {
+          if (sdi->method != sdi12_dr::continuous)
+            {
+              sdi->method = sdi12_dr::data;
+              sdi->index = 0;
+            }
+          else
+            {
+              // no count is announced, but it may have been learned
+              sdi12_schema::entry_t entry;
+              measurements = dacqh->data_count;
+              if (schema_ != nullptr
+                  && schema_->find (sdi->addr, sdi->method, sdi->index, entry))
+                {
+                  measurements = std::min (measurements, entry.values);
+                }
+            }
+
+          // get sensor data
+          if ((binary ?
+              get_binary (sdi, dacqh->data, dacqh->status, measurements) :
+              get_data (sdi, dacqh->data, sdi->fixed, dacqh->status,
+                        measurements, pages)) == false)
+            {
+              if (sr_missed_ && addr_to_index (sdi->addr) >= 0)
+                {
+                  // the data was requested too early, be patient next time
+                  sr_grace_[addr_to_index (sdi->addr)] = SDI_SR_GRACE;
+                }
+              measurements = 0; // the values are not valid
+              break;
+            }
+          stamp (dacqh,
+                 sdi->method == sdi12_dr::continuous ? rx_end_us_ : ready_us_);
+          error = &err_[ok];
+          result = true;
+        }
+      else
+        {
+          error = &err_[no_sensor_data];
+        }
+    }
+  while (0);
+
+  dacqh->data_count = measurements;
+
+  return result;
+}
+
+/**
+ * @brief Record the timestamps of a successful retrieval in its handle.
+ * @param dacqh: pointer on the request.
+ * @param ready: when the measurement completed, in µs of the clock; the data
+ *      was received at the end of the last answer.
+ */
+void
+sdi12_dr::stamp (dacq_handle_t* dacqh, uint64_t ready)
+{
+  dacqh->ready = wall_us (ready);
+  dacqh->received = wall_us (rx_end_us_);
+  dacqh->date = dacqh->ready / 1000000;
+  if (stats_ != nullptr)
+    {
+      stats_->collect (
+          addr_to_index (((sdi12_t*) dacqh->impl)->addr),
+          rx_end_us_ > ready ? (rx_end_us_ - ready) / 1000 : 0);
+    }
+}
+
+/**
+ * @brief Hand a finished request to its user call-back: queue it if a
+ *      dispatch queue is installed, or call the call-back at once if there
+ *      is none or if the queue is full.
+ * @param dacqh: pointer on the request; it must stay valid until the
+ *      call-back was called.
+ * @param done: function to be called after the call-back, or nullptr.
+ * @param context: parameter of the done function.
+ */
+void
+sdi12_dr::dispatch (dacq_handle_t* dacqh, dacq_dispatch::release_t done,
+                    void* context)
+{
+  if (dacqh->cb != nullptr && dispatch_ != nullptr
+      && dispatch_->post (dacqh, done, this, context) == true)
+    {
+      return;
+    }
 
-  // check if we need to send a break
-  if (last_sdi_addr_ != buff[0] || (sysclock.now () - last_sdi_time_) > 85)
+  if (dacqh->cb != nullptr)
+    {
+      dacqh->cb (dacqh);
+    }
+  if (done != nullptr)
+    {
+      done (this, context);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+// --------------------------------------------------------------------------
+
+/**
+ * @brief Prepare the line for a command: send a break if needed (see
+ *      sdi12_break_policy), then let the line mark for at least 8.33 ms.
+ * @param addr: address the command is sent to.
+ * @param strict: if true, a break is sent whenever the address changes.
+ */
+void
+sdi12_dr::prepare (char addr, bool strict)
+{
+  // check if we need to send a break: for how long the line was marking?
+  clock::timestamp_t idle = clock_->now () - last_sdi_time_;
+  if (last_sdi_addr_ == 0 || break_policy_->need_break (
+      addr, last_sdi_addr_,
+      (clock::duration_t) std::min (idle, (clock::timestamp_t) 0xFFFFFFFF),
+      strict))
     {
       // send a break at least 12 ms long
-      first = sysclock.now () - origin_;
-      tty_->tcsendbreak (SDI_BREAK_LEN);
-      dump ("%05d-%05d --> break", first, first + SDI_BREAK_LEN);
+      record (clock_->now_us (), sdi12_trace::brk, addr, nullptr, 0,
+              SDI_BREAK_LEN);
+      tally (addr, sdi12_stats::breaks);
+      transport_->send_break (SDI_BREAK_LEN);
 #if SDI_DEBUG == true
           trace::printf ("%s(): break\n", __func__);
 #endif
     }
-  last_sdi_addr_ = buff[0];         // replace last address
+  last_sdi_addr_ = addr;            // replace last address
 
   // wait at least 8.33 ms
-  sysclock.sleep_for (10);
+  clock_->sleep_for (10);
+}
+
+/**
+ * @brief Probe an address with a single acknowledge command ("a!"), without
+ *      repetition: the first character of the answer must be received
+ *      within SDI_PROBE_TIMEOUT ms after the command. Used to scan the bus.
+ * @param addr: address to probe.
+ * @return true if the sensor acknowledged, false otherwise.
+ */
+bool
+sdi12_dr::probe (char addr)
+{
+  char cmd[2] =
+    { addr, '!' };
+  bool result = false;
+  ssize_t res;
+
+  prepare (addr, false);
+  transport_->flush (TCIOFLUSH);   // clear input
+
+  os::rtos::clock::timestamp_t xmit_end = clock_->now () + (83 * 2) / 10;
+  record (clock_->now_us (), sdi12_trace::command, addr, cmd, sizeof(cmd));
+  if (transport_->write (cmd, sizeof(cmd)) < 0)
+    {
+      record (clock_->now_us (), sdi12_trace::write_failed, addr);
+      error = &err_[tty_error];
+      return false;
+    }
+  clock_->sleep_until (xmit_end);
+  last_sdi_time_ = clock_->now ();
+
+  // only the first character has a tight timeout, the rest follows at once
+  rx_frame_.reset ();
+  res = transport_->read (rx_frame_.tail (), rx_frame_.wanted (),
+                          SDI_PROBE_TIMEOUT);
+  while (res > 0 && rx_frame_.commit (res) == false
+      && rx_frame_.full () == false)
+    {
+      res = transport_->read (rx_frame_.tail (), rx_frame_.wanted ());
+    }
 
-  int retries = 3;
-  tty_->tcflush (TCIOFLUSH);        // clear input
+  if (rx_frame_.complete ())
+    {
+      record (clock_->now_us (), sdi12_trace::answer, rx_frame_.data ()[0],
+              rx_frame_.data (), rx_frame_.length ());
+      last_sdi_time_ = clock_->now ();
+      result = rx_frame_.length () == 3 && rx_frame_.data ()[0] == addr;
+      if (result == true)
+        {
+          // it answers again, give it the full budget for the verification
+          retry_policy_->result (addr_to_index (addr), true, clock_->now ());
+        }
+    }
+  else
+    {
+      record (clock_->now_us (), sdi12_trace::timeout, addr);
+    }
+  error = &err_[res < 0 ? tty_error : ok];
+
+  return result;
+}
+
+/**
+ * @brief Perform an SDI-12 transaction using the RS-485 tty.
+ * @param buff: buffer containing the SDI-12 request; on return, the buffer
+ *      should contain the SDI-12 answer from the sensor.
+ * @param cmd_len: command length.
+ * @param len: buffer's total length.
+ * @param strict: if true, a break is sent whenever the address changes.
+ * @param packet: if not nullptr, the answer is a binary packet, which is
+ *      decoded as it is received instead of being returned in the buffer.
+ * @return: Number of characters returned, or -1 on error.
+ */
+int
+sdi12_dr::transaction (char* buff, size_t cmd_len, size_t len, bool strict,
+                       sdi12_binary* packet)
+{
+  int result = 0;
+  err_num_t err_no = timeout;
+  char addr = buff[0];
+  int index = addr_to_index (addr);
+
+  // a sensor that stopped answering is not asked as often
+  int attempts = retry_policy_->attempts (index, clock_->now ());
+  spare (addr, sdi12_retry_policy::full_attempts - attempts);
+  if (attempts <= 0)
+    {
+      error = &err_[timeout];
+      return 0;
+    }
+
+  prepare (addr, strict);
+
+  int retries = attempts;
+  transport_->flush (TCIOFLUSH);   // clear input
   do
     {
+      tally (addr, retries == attempts ? sdi12_stats::transactions :
+                                         sdi12_stats::retries);
 #if SDI_DEBUG == true
           trace::printf ("%s(): sent %.*s\n", __func__, cmd_len, buff);
 #endif
       // compute time taken by write
-      os::rtos::clock::timestamp_t xmit_end = sysclock.now ()
+      os::rtos::clock::timestamp_t xmit_end = clock_->now ()
           + (83 * cmd_len) / 10;
 
       // send request
-      first = sysclock.now () - origin_;
-      dump ("%05d-%05d --> %.*s", first, first + ((cmd_len * 8333) / 1000),
-            cmd_len, buff);
-      if ((result = tty_->write (buff, cmd_len)) < 0)
+      os::rtos::clock::timestamp_t attempt_start = clock_->now ();
+      uint64_t sent_us = clock_->now_us () + cmd_len * 8333;
+      record (clock_->now_us (), sdi12_trace::command, buff[0], buff, cmd_len);
+      if ((result = transport_->write (buff, cmd_len)) < 0)
         {
-          dump ("%05d-~~~~~ --> write failed", sysclock.now () - origin_);
+          record (clock_->now_us (), sdi12_trace::write_failed, buff[0]);
           err_no = tty_error;
           break;
         }
 
       // wait for the end of transmission
-      sysclock.sleep_until (xmit_end);
-      last_sdi_time_ = sysclock.now ();
+      clock_->sleep_until (xmit_end);
+      last_sdi_time_ = clock_->now ();
 
-      // read response, if any
-      size_t offset = 0;
-      bool valid_sdi12 = false;
-      do
+      bool received;
+      if (packet != nullptr)
         {
-          result = tty_->read (answer + offset, sizeof(answer) - offset);
-          if (result <= 0)
+          // binary packet: its length is known once the header arrived,
+          // the bytes are decoded as they come; packets are sent with 8 data
+          // bits and no parity, so the port is switched for the packet only
+          uint8_t chunk[32];
+          packet->reset ();
+          if (transport_->set_attributes (baudrate_, CS8, 0, rec_timeout_)
+              == false)
             {
+              err_no = tty_attr;
+              result = -1;
               break;
             }
-          offset += result;
-          // check if the frame is valid
-          if (answer[offset - 1] == '\n' && answer[offset - 2] == '\r')
+          do
+            {
+              result = transport_->read (
+                  chunk, std::min (packet->wanted (), sizeof(chunk)));
+              if (result <= 0)
+                {
+                  break;
+                }
+            }
+          while (packet->put (chunk, result) == false);
+          received = packet->complete ();
+          if (transport_->set_attributes (baudrate_, c_size_, parity_,
+                                          rec_timeout_) == false)
             {
-              valid_sdi12 = true;
-              result = offset;
+              err_no = tty_attr;
+              result = -1;
               break;
             }
-          // we read until we get a valid frame or overflow the buffer
         }
-      while (offset < sizeof(answer));
+      else
+        {
+          // read response, if any; the frame is complete as soon as the
+          // CR/LF pair arrived, no matter how the bytes are split between
+          // reads
+          rx_frame_.reset ();
+          do
+            {
+              result = transport_->read (rx_frame_.tail (),
+                                         rx_frame_.wanted ());
+              if (result <= 0)
+                {
+                  break;
+                }
+              // we read until we get a valid frame or overflow the buffer
+            }
+          while (rx_frame_.commit (result) == false
+              && rx_frame_.full () == false);
+          received = rx_frame_.complete ();
+        }
 
-      if (valid_sdi12 && result > 0)
+      if (received)
         {
+          rx_end_us_ = clock_->now_us ();
+          os::rtos::clock::timestamp_t wait_end = clock_->now () + 20;
+          if (packet != nullptr)
+            {
+              result = sdi12_binary::header_size + packet->size ()
+                  + sdi12_binary::crc_size;
+              record (rx_end_us_, sdi12_trace::packet, packet->address (),
+                      packet->header (), sdi12_binary::header_size);
+            }
+          else
+            {
+              const char* answer = rx_frame_.data ();
+              result = rx_frame_.length ();
 #if SDI_DEBUG == true
               trace::printf ("%s(): received %.*s\n", __func__, result, answer);
 #endif
-          os::rtos::clock::timestamp_t wait_end = sysclock.now () + 20;
-          first = sysclock.now () - origin_ - (((result + 1) * 8333) / 1000);
-          int last = sysclock.now () - origin_ - 8;
-          dump ("%05d-%05d <-- %.*s", first, last, result, answer);
-          sysclock.sleep_until (wait_end);
-          strncpy (buff, answer, len);
-          last_sdi_time_ = sysclock.now ();
+              record (rx_end_us_, sdi12_trace::answer, answer[0], answer,
+                      result);
+              result = std::min ((size_t) result, len - 1);
+              memcpy (buff, answer, result);
+              buff[result] = '\0';
+            }
+          if (stats_ != nullptr)
+            {
+              stats_->answer (
+                  addr_to_index (addr),
+                  rx_end_us_ > sent_us ? (rx_end_us_ - sent_us) / 1000 : 0);
+            }
+          clock_->sleep_until (wait_end);
+          last_sdi_time_ = clock_->now ();
           err_no = ok;
           break;
         }
@@ -430,18 +1145,30 @@ sdi12_dr::transaction (char* buff, size_t cmd_len, size_t len)
 #if SDI_DEBUG == true
               trace::printf ("%s(): timeout\n", __func__);
 #endif
-          dump ("~~~~~-%05d <-- timeout", sysclock.now () - origin_);
+          record (clock_->now_us (), sdi12_trace::timeout, buff[0]);
+          tally (addr, sdi12_stats::timeouts);
+          if (index >= 0)
+            {
+              miss_ms_[index] = std::min (clock_->now () - attempt_start,
+                                          (clock::timestamp_t) UINT16_MAX);
+            }
         }
     }
   while (--retries);
 
+  if (err_no != tty_error)
+    {
+      retry_policy_->result (index, err_no == ok, clock_->now ());
+    }
   error = &err_[err_no];
+  flush_dump ();        // the built-in ring holds a few transactions only
 
   return result;
 }
 
 /**
- * @brief Start a two-steps measurement using "M", "C" or "V" SDI-12 commands.
+ * @brief Start a two-steps measurement using "M", "C", "V", "HA" or "HB"
+ *      SDI-12 commands.
  * @param sdi: a asdi12_t type structure defining a sensor.
  * @param response_delay: number of seconds the sensor needs to return the values.
  * @param measurements: the number of values that will be returned by the sensor.
@@ -449,40 +1176,49 @@ sdi12_dr::transaction (char* buff, size_t cmd_len, size_t len)
  */
 bool
 sdi12_dr::start_measurement (sdi12_t* sdi, int& response_delay,
-                             uint8_t& measurements)
+                             uint16_t& measurements)
 {
   bool result = false;
   char buff[32];
   int count;
-  int retries = retries_with_break;
+  int retries = rounds (sdi->addr);
 
-  if (sdi->index < 10)
+  bool high_volume = sdi->method == sdi12_dr::high_volume_ascii
+      || sdi->method == sdi12_dr::high_volume_binary;
+
+  if (sdi->index < 10 && (high_volume == false || sdi->index == 0))
     {
       do
         {
           buff[0] = sdi->addr;
-          buff[1] = sdi->method;
-          buff[2] = sdi->use_crc ? 'C' : sdi->index ? sdi->index + '0' : '!';
-          buff[3] =
-              sdi->use_crc ?
-                  (sdi->index ? sdi->index + '0' : '!') :
-                  (sdi->index ? '!' : '\0');
-          buff[4] = (sdi->use_crc && sdi->index) ? '!' : '\0';
-          buff[5] = '\0';
+          size_t len = 1 + measurement_command (sdi, buff + 1);
+          buff[len++] = '!';
 
-          if ((count = transaction (buff, strlen (buff), sizeof(buff))) > 0)
+          if ((count = transaction (buff, len, sizeof(buff),
+                                    sdi->strict_break)) > 0)
             {
-              if (sdi->addr != buff[0] || count < 7)
+              uint16_t ttt;
+              if (measurement_answer (buff, count, sdi->addr, ttt,
+                                      measurements) == false)
                 {
-                  // answer from wrong sensor or too short
                   error = &err_[unexpected_answer];
+                  tally (sdi->addr, sdi12_stats::unexpected);
                 }
               else
                 {
-                  buff[count - 2] = '\0';
-                  measurements = (uint8_t) atoi (&buff[4]);
-                  buff[4] = '\0';
-                  response_delay = atoi (&buff[1]);
+                  response_delay = ttt;
+                  sdi12_schema::entry_t entry;
+                  if (schema_ != nullptr
+                      && schema_->find (sdi->addr, sdi->method, sdi->index,
+                                        entry)
+                      && (entry.values != measurements
+                          || entry.ttt != response_delay))
+                    {
+                      // the sensor was reconfigured, keep the cache current
+                      entry.values = measurements;
+                      entry.ttt = response_delay;
+                      schema_->store (entry);
+                    }
                   result = true;
                   break;
                 }
@@ -500,7 +1236,14 @@ sdi12_dr::start_measurement (sdi12_t* sdi, int& response_delay,
 }
 
 /**
- * @brief Wait for a service request from a sensor.
+ * @brief Wait for a service request from a sensor. The wait ends at the
+ *      announced time plus a grace period learned for each sensor: sensors
+ *      that send the service request on time get a short grace period,
+ *      late sensors one that covers how late they were recently, and
+ *      sensors never seen sending a service request SDI_SR_GRACE (see also
+ *      retrieve_sequential()); when a learned grace period expires, the
+ *      wait goes on up to SDI_SR_GRACE. The service request is assembled like any
+ *      answer, so it may arrive split between reads.
  * @param sdi: a asdi12_t type structure defining a sensor.
  * @param response_delay: number of seconds to wait until the sensor answer,
  *      after which the function returns.
@@ -512,70 +1255,110 @@ bool
 sdi12_dr::wait_for_service_request (sdi12_t* sdi, int response_delay)
 {
   bool result = false;
-  err_num_t err_no = tty_attr;
-  char buff[4];
-  size_t res;
-  struct termios tio;
-
-  if (sdi->method == sdi12_dr::concurrent)
+  err_num_t err_no = ok;
+  bool received = false;
+  ssize_t res = 0;
+
+  // until a service request arrives, the measurement ends at the ETA
+  ready_us_ = clock_->now_us () + response_delay * 1000000ULL;
+  flush_dump ();        // while the sensor measures
+  if (sdi->method == sdi12_dr::concurrent
+      || sdi->method == sdi12_dr::high_volume_ascii
+      || sdi->method == sdi12_dr::high_volume_binary)
     {
-      sysclock.sleep_for (response_delay * 1000);
-      err_no = ok;
-      result = true;
+      // high volume measurements send no service request either
+      clock_->sleep_for (response_delay * 1000);
+      error = &err_[ok];
+      return true;
     }
-  else if (tty_->tcgetattr (&tio) >= 0)
-    {
-      // save original values
-      cc_t vtime = tio.c_cc[VTIME];
-      cc_t vtime_ms = tio.c_cc[VTIME_MS];
 
-      tio.c_cc[VTIME] = 10; // wait for one second timeout
-      tio.c_cc[VTIME_MS] = 0;
+  int index = addr_to_index (sdi->addr);
+  uint16_t unknown = 0;
+  uint16_t& grace = index >= 0 ? sr_grace_[index] : unknown;
+  if (grace == 0)
+    {
+      grace = SDI_SR_GRACE;     // nothing learned yet
+    }
+  clock::timestamp_t deadline = clock_->now () + response_delay * 1000;
+  clock::timestamp_t limit = deadline + grace;
+  clock::timestamp_t now;
 
-      if (tty_->tcsetattr (TCSANOW, &tio) >= 0)
+  rx_frame_.reset ();
+  while ((now = clock_->now ()) < limit || limit < deadline + SDI_SR_GRACE)
+    {
+      if (now >= limit)
         {
-          do
-            {
-              res = tty_->read (buff, sizeof(buff));
-            }
-          while (--response_delay > 0 && res == 0);
-
-          if (res > 0 && sdi->addr == buff[0])
+          // the learned grace was too short, the sensor may have become
+          // slower: wait as long as for an unknown sensor, not to lose the
+          // measurement
+          limit = deadline + SDI_SR_GRACE;
+          continue;
+        }
+      res = transport_->read (rx_frame_.tail (), rx_frame_.wanted (),
+                              limit - now);
+      if (res < 0)
+        {
+          err_no = tty_error;
+          break;
+        }
+      if (res > 0 && rx_frame_.commit (res))
+        {
+          // skip the frames that are not our service request; with reads
+          // of several bytes, more than one frame may already be buffered
+          while (rx_frame_.complete ()
+              && (rx_frame_.length () != 3
+                  || rx_frame_.data ()[0] != sdi->addr))
             {
-              // got a service request
-              last_sdi_time_ = sysclock.now ();
-              last_sdi_addr_ = sdi->addr;
-              int first = sysclock.now () - origin_
-                  - (((res + 1) * 8333) / 1000);
-              int last = sysclock.now () - origin_ - 8;
-              dump ("%05d-%05d <-- %.*s", first, last, res, buff);
+              rx_frame_.next ();
             }
-          else
+          if (rx_frame_.complete ())
             {
-              // timeout is up, add half a second wait before requesting the data,
-              // for sensors with flawed implementations
-              sysclock.sleep_for (500);
+              received = true;
+              break;
             }
+        }
+      else if (rx_frame_.full ())
+        {
+          rx_frame_.reset ();
+        }
+    }
+
+  if (received)
+    {
+      // got a service request; the sensor started sending it when the
+      // measurement completed
+      ready_us_ = clock_->now_us () - 4 * 8333;
+      last_sdi_time_ = clock_->now ();
+      last_sdi_addr_ = sdi->addr;
+      record (ready_us_ + 4 * 8333, sdi12_trace::answer, sdi->addr,
+              rx_frame_.data (), 3);
+
+      if (stats_ != nullptr)
+        {
+          stats_->response (index, response_delay * 1000,
+                            last_sdi_time_ - (deadline - response_delay * 1000));
+        }
+
+      // learn how late the sensor is
+      uint32_t late = last_sdi_time_ > deadline ? last_sdi_time_ - deadline : 0;
+      uint32_t target = 2 * late + SDI_SR_GRACE_MIN;
+      grace = target > grace ? std::min (target, (uint32_t) SDI_SR_GRACE) :
+          std::max (target, (uint32_t) (grace - grace / 4));
+    }
+  sr_missed_ = !received;
+  if (sr_missed_ && err_no == ok)
+    {
+      tally (sdi->addr, sdi12_stats::sr_missing);
+    }
 
 #if SDI_DEBUG == true
-          if (res > 0)
-            {
-              trace::printf ("%s(): received %.*s\n", __func__, res, buff);
-            }
-          else
-            {
-              trace::printf ("%s(): timeout\n", __func__);
-            }
+  trace::printf ("%s(): %s, grace %u ms\n", __func__,
+                 received ? "service request" : "timeout", grace);
 #endif
 
-          tio.c_cc[VTIME] = vtime; // restore original timeout values
-          tio.c_cc[VTIME_MS] = vtime_ms;
-          if (tty_->tcsetattr (TCSANOW, &tio) == 0)
-            {
-              err_no = ok;
-              result = true;
-            }
-        }
+  if (err_no == ok)
+    {
+      result = true;
     }
   error = &err_[err_no];
 
@@ -586,82 +1369,103 @@ sdi12_dr::wait_for_service_request (sdi12_t* sdi, int response_delay)
  * @brief Implementation of the SDI-12 "Send Data" command.
  * @param sdi: a asdi12_t type structure defining a sensor.
  * @param data: pointer on an array of floats where the data will be returned.
+ * @param fixed: pointer on an array where the data will be returned as
+ *      mantissa and exponent instead, without conversion; if not nullptr,
+ *      data is not used.
  * @param status: pointer on an array of sensor statuses.
  * @param measurements: maximum number of values allowed in 'data'. On return,
  *      it contains the actual number of values returned by the sensor.
+ * @param pages: number of data pages the sensor may return (10 for "D0" to
+ *      "D9", 1000 for high volume measurements, "D0" to "D999", whose pages
+ *      always carry a CRC). The values are parsed into the arrays as each
+ *      page is received.
  * @return true if successful, false otherwise.
  */
 bool
-sdi12_dr::get_data (sdi12_t* sdi, float* data, uint8_t* status,
-                    uint8_t& measurements)
+sdi12_dr::get_data (sdi12_t* sdi, float* data, dacq_fixed_t* fixed,
+                    uint8_t* status, uint16_t& measurements, uint16_t pages)
 {
   bool result = false;
   char buff[longest_sdi12_frame];
-  char request = sdi->index + '0';
-  uint8_t parsed = 0;
+  uint16_t request = sdi->index;
+  uint16_t parsed = 0;
+  uint16_t page = 0;
   int count;
+  // SDI-12 1.4 has no high volume ASCII measurement without CRC
+  bool crc = sdi->use_crc || pages > 10;
 
-  if (data != nullptr && status != nullptr)
+  if ((data != nullptr || fixed != nullptr) && status != nullptr)
     {
       // set all status bytes to "missing values"
       memset (status, STATUS_BIT_MISSING, measurements);
       do
         {
-          int retries = retries_with_break;
+          int retries = rounds (sdi->addr);
 
           do
             {
-              buff[0] = sdi->addr;
-              buff[1] = sdi->method;
-              buff[2] =
-                  (sdi->method == sdi12_dr::continuous && sdi->use_crc) ?
-                      'C' : request;
-              buff[3] =
-                  (sdi->method == sdi12_dr::continuous && sdi->use_crc) ?
-                      request : '!';
-              buff[4] =
-                  (sdi->method == sdi12_dr::continuous && sdi->use_crc) ?
-                      '!' : '\0';
-              buff[5] = '\0';
-
-              if ((count = transaction (buff, strlen (buff), sizeof(buff))) > 0)
+              size_t len = 0;
+              buff[len++] = sdi->addr;
+              buff[len++] = sdi->method;
+              if (sdi->method == sdi12_dr::continuous && sdi->use_crc)
+                {
+                  buff[len++] = 'C';
+                }
+              len += put_index (buff + len, request);
+              buff[len++] = '!';
+
+              if ((count = transaction (buff, len, sizeof(buff),
+                                        sdi->strict_break)) > 0)
                 {
                   do
                     {
-                      if (sdi->addr != buff[0] || (sdi->use_crc && count < 6))
+                      if (sdi->addr != buff[0] || (crc && count < 6))
                         {
                           error = &err_[unexpected_answer];
+                          tally (sdi->addr, sdi12_stats::unexpected);
                           break;
                         }
-                      if (sdi->use_crc)
+                      // the CRC was verified while the frame was received
+                      if (crc && rx_frame_.crc_valid () == false)
                         {
-                          // verify the CRC
-                          char* p = buff + count - 5; // p points on the first CRC byte
-                          uint16_t incoming_crc = (*p++ & 0x3F) << 12;
-                          incoming_crc += (*p++ & 0x3F) << 6;
-                          incoming_crc += (*p & 0x3F);
-                          if (incoming_crc
-                              != sdi12_dr::calc_crc (0, (uint8_t*) buff,
-                                                     count - 5))
-                            {
-                              error = &err_[crc_error];
-                              break;
-                            }
+                          error = &err_[crc_error];
+                          tally (sdi->addr, sdi12_stats::crc_errors);
+                          break;
                         }
-                      char* p, * r = buff + 1; // skip address
-                      buff[count - (sdi->use_crc ? 5 : 2)] = '\0'; // terminate string
-                      do
+                      // parse the values (skip address, CRC and CR/LF)
+                      sdi12_parser parser
+                        { buff + 1, buff + count - (crc ? 5 : 2) };
+                      sdi12_parser::token_t token = sdi12_parser::end;
+                      int32_t mantissa;
+                      int8_t exponent;
+                      page = 0;
+                      while (parsed + page < measurements
+                          && (token = parser.next (mantissa, exponent))
+                              == sdi12_parser::value)
                         {
-                          p = r;
-                          data[parsed] = strtof (p, &r);
-                          if (data[parsed] == 0 && p == r)
+                          if (fixed != nullptr)
+                            {
+                              fixed[parsed + page].mantissa = mantissa;
+                              fixed[parsed + page].exponent = exponent;
+                            }
+                          else
                             {
-                              error = &err_[conversion_to_float_error];
-                              break;    // conversion to float error, exit
+                              data[parsed + page] = sdi12_parser::to_float (
+                                  mantissa, exponent);
                             }
-                          status[parsed++] = STATUS_OK;
+                          page++;
+                        }
+                      if (token == sdi12_parser::error)
+                        {
+                          record (clock_->now_us (),
+                                  sdi12_trace::invalid_value, sdi->addr,
+                                  nullptr, 0, parser.position () + 1);
+                          error = &err_[conversion_to_float_error];
+                          tally (sdi->addr, sdi12_stats::parse_errors);
+                          break;
                         }
-                      while (*r != '\0');
+                      memset (status + parsed, STATUS_OK, page);
+                      parsed += page;
                     }
                   while (0);
                 }
@@ -681,8 +1485,8 @@ sdi12_dr::get_data (sdi12_t* sdi, float* data, uint8_t* status,
               break;
             }
         }
-      while (request++ < '9' && count > 0 && parsed < measurements
-          && error->error_number == ok);
+      while (++request < pages && count > 0 && page > 0
+          && parsed < measurements && error->error_number == ok);
 
       // any values retrieved?
       if (parsed)
@@ -690,57 +1494,250 @@ sdi12_dr::get_data (sdi12_t* sdi, float* data, uint8_t* status,
           measurements = parsed;
           result = true;
         }
+      else if (error->error_number == ok)
+        {
+          error = &err_[no_sensor_data];        // only empty pages
+        }
     }
 
   return result;
 }
 
 /**
- * @brief Compute the CRC of an SDI-12 string.
- * @param initial: initial CRC value (normally 0).
- * @param buff: buffer containing the SDI-12 string.
- * @param buff_len: length of the SDI-12 string.
- * @return Computed CRC value for the SDI-12 string.
+ * @brief Retrieve the data of a high volume binary measurement with the
+ *      SDI-12 "DB" commands; each packet is decoded into 'data' as it is
+ *      received.
+ * @param sdi: a asdi12_t type structure defining a sensor.
+ * @param data: pointer on an array of floats where the data will be returned.
+ * @param status: pointer on an array of sensor statuses.
+ * @param measurements: maximum number of values allowed in 'data'. On return,
+ *      it contains the actual number of values returned by the sensor.
+ * @return true if successful, false otherwise.
  */
-uint16_t
-sdi12_dr::calc_crc (uint16_t initial, uint8_t* buff, uint16_t buff_len)
+bool
+sdi12_dr::get_binary (sdi12_t* sdi, float* data, uint8_t* status,
+                      uint16_t& measurements)
 {
+  bool result = false;
+  char buff[8];
+  uint16_t request = 0;
+  uint16_t parsed = 0;
+  sdi12_binary packet;
+  int count;
 
-  for (uint16_t count = 0; count < buff_len; count++)
+  if (data != nullptr && status != nullptr)
     {
-      initial ^= *buff++;
-      int cnt_byte = 8;
-      while (cnt_byte-- > 0)
+      // set all status bytes to "missing values"
+      memset (status, STATUS_BIT_MISSING, measurements);
+      do
         {
-          if (initial & 1)
+          int retries = rounds (sdi->addr);
+
+          do
             {
-              initial >>= 1;
-              initial ^= 0xA001;
+              size_t len = 0;
+              buff[len++] = sdi->addr;
+              buff[len++] = 'D';
+              buff[len++] = 'B';
+              len += put_index (buff + len, request);
+              buff[len++] = '!';
+
+              packet.begin (data + parsed, measurements - parsed);
+              if ((count = transaction (buff, len, sizeof(buff),
+                                        sdi->strict_break, &packet)) > 0)
+                {
+                  if (sdi->addr != packet.address ()
+                      || packet.size () > sdi12_binary::max_payload)
+                    {
+                      // wrong sensor, or a corrupt size ended the packet
+                      error = &err_[unexpected_answer];
+                      tally (sdi->addr, sdi12_stats::unexpected);
+                    }
+                  else if (packet.crc_valid () == false)
+                    {
+                      error = &err_[crc_error];
+                      tally (sdi->addr, sdi12_stats::crc_errors);
+                    }
+                  else if (packet.valid () == false)
+                    {
+                      record (clock_->now_us (), sdi12_trace::invalid_value,
+                              sdi->addr, nullptr, 0, packet.type ());
+                      error = &err_[conversion_to_float_error];
+                      tally (sdi->addr, sdi12_stats::parse_errors);
+                    }
+                  else
+                    {
+                      memset (status + parsed, STATUS_OK, packet.count ());
+                      parsed += packet.count ();
+                    }
+                }
+              if (error->error_number == ok)
+                {
+                  break;
+                }
+              else
+                {
+                  force_break ();
+                }
             }
-          else
-            initial >>= 1;
+          while (--retries);
+        }
+      // an empty packet ends the data
+      while (++request < 1000 && count > 0 && packet.size () > 0
+          && parsed < measurements && error->error_number == ok);
+
+      // any values retrieved?
+      if (parsed)
+        {
+          measurements = parsed;
+          result = true;
+        }
+      else if (error->error_number == ok)
+        {
+          error = &err_[no_sensor_data];        // only empty packets
+        }
+    }
+
+  return result;
+}
+
+/**
+ * @brief Append the decimal index of a data page to a command.
+ * @param buff: where the digits are stored.
+ * @param index: page index, 0 to 999.
+ * @return the number of digits.
+ */
+size_t
+sdi12_dr::put_index (char* buff, uint16_t index)
+{
+  size_t len = 0;
+
+  if (index >= 100)
+    {
+      buff[len++] = index / 100 + '0';
+    }
+  if (index >= 10)
+    {
+      buff[len++] = index / 10 % 10 + '0';
+    }
+  buff[len++] = index % 10 + '0';
+
+  return len;
+}
+
+/**
+ * @brief Store the command of a measurement, without address and '!',
+ *      e.g. "M", "MC1", "C", "V", "R0", "HA" or "HB".
+ * @param sdi: a sdi12_t type structure defining the measurement.
+ * @param buff: where the command is stored.
+ * @return the command length.
+ */
+size_t
+sdi12_dr::measurement_command (sdi12_t* sdi, char* buff)
+{
+  size_t len = 0;
+
+  if (sdi->method == sdi12_dr::high_volume_ascii
+      || sdi->method == sdi12_dr::high_volume_binary)
+    {
+      buff[len++] = 'H';
+      buff[len++] = sdi->method == sdi12_dr::high_volume_ascii ? 'A' : 'B';
+    }
+  else
+    {
+      buff[len++] = sdi->method;
+      if (sdi->use_crc)
+        {
+          buff[len++] = 'C';
         }
+      if (sdi->index || sdi->method == sdi12_dr::continuous)
+        {
+          buff[len++] = sdi->index + '0';
+        }
+    }
+
+  return len;
+}
+
+/**
+ * @brief Check and decode the answer to a measurement command or to its
+ *      metadata command ("atttn" to "atttnnn" and CR/LF).
+ * @param buff: the answer.
+ * @param count: length of the answer.
+ * @param addr: address of the sensor.
+ * @param ttt: returns the measurement time, in seconds.
+ * @param values: returns the number of values.
+ * @return true if the answer is valid, false if it comes from another
+ *      sensor, is too short or is garbled (it has no CRC, but it must be
+ *      made of digits only).
+ */
+bool
+sdi12_dr::measurement_answer (const char* buff, int count, char addr,
+                              uint16_t& ttt, uint16_t& values)
+{
+  if (buff[0] != addr || count < 7
+      || strspn (buff + 1, "0123456789") != (size_t) count - 3)
+    {
+      return false;
     }
 
-  return initial;
+  ttt = (buff[1] - '0') * 100 + (buff[2] - '0') * 10 + (buff[3] - '0');
+  values = 0;
+  for (int i = 4; i < count - 2; i++)
+    {
+      values = values * 10 + buff[i] - '0';
+    }
+
+  return true;
 }
 
 /**
- * @brief Dump the transaction dialogue to a hooked-up function (for protocol debug).
- * @param fmt: formatted string (printf() style).
+ * @brief Format the events recorded since the last call for the dump
+ *      function (for protocol debug), with the times relative to the first
+ *      one, followed by the number of events lost, if any; called after
+ *      each transaction and while waiting for a sensor, when the bus timing
+ *      no longer matters.
  */
 void
-sdi12_dr::dump (const char* fmt, ...)
+sdi12_dr::flush_dump (void)
 {
-  if (dump_fn_)
+  uint8_t raw[sdi12_trace::header_size + longest_sdi12_frame];
+  sdi12_trace::event_t event;
+  uint64_t base = 0;
+  size_t count;
+
+  if (trace_ != nullptr || dump_fn_ == nullptr)
     {
-      va_list ap;
+      return;
+    }
 
-      memset (dump_buffer_, 0, sizeof(dump_buffer_));
-      va_start(ap, fmt);
-      vsnprintf (dump_buffer_, sizeof(dump_buffer_), fmt, ap);
-      va_end(ap);
+  while ((count = dump_trace_.read (raw, sizeof(raw))) > 0)
+    {
+      size_t pos = 0;
+      size_t n;
+      while ((n = sdi12_trace::decode (raw + pos, count - pos, dump_high_,
+                                       event)) > 0)
+        {
+          pos += n;
+          if (event.type == sdi12_trace::time_high)
+            {
+              continue;
+            }
+          base = base ? base : event.time;
+          if (sdi12_trace::format (event, base, dump_buffer_,
+                                   sizeof(dump_buffer_)) > 0)
+            {
+              dump_fn_ (dump_buffer_);
+            }
+        }
+    }
 
+  uint32_t lost = dump_trace_.dropped ();
+  if (lost != dump_lost_)
+    {
+      snprintf (dump_buffer_, sizeof(dump_buffer_), "%" PRIu32 " events lost",
+                lost - dump_lost_);
+      dump_lost_ = lost;
       dump_fn_ (dump_buffer_);
     }
 }
@@ -751,130 +1748,416 @@ sdi12_dr::dump (const char* fmt, ...)
  *      data is collected, a user call-back function will be called.
  * @param dacqh: pointer on a structure of type dacq_handle_t containing all
  *      sensor relevant data.
+ * @param planned: true if the request is part of a retrieve_many() sweep.
  * @return true if successful, false otherwise.
  */
 bool
-sdi12_dr::retrieve_concurrent (dacq_handle_t* dacqh)
+sdi12_dr::retrieve_concurrent (dacq_handle_t* dacqh, bool planned)
 {
   bool result = false;
-  int waiting_time;
-  uint8_t measurements;
+  concurent_msg_t* pmsg;
+
+  if ((pmsg = reserve (dacqh)) != nullptr)
+    {
+      // initiate a concurrent measurement
+      if (start_concurrent (pmsg) == false)
+        {
+          release (pmsg);
+        }
+      else
+        {
+          pmsg->planned = planned;
+          submit (pmsg);
+          result = true;
+        }
+    }
+
+  return result;
+}
+
+/**
+ * @brief Retrieve data without blocking the caller, with any method: the
+ *      request is queued and executed by the collect thread, including the
+ *      measurement command, the wait for the service request and the data
+ *      collection; the caller does not even wait for the bus. On completion,
+ *      the user call-back is called (by the collect thread), then the
+ *      completion handle (if any) is completed; with a dispatch queue (see
+ *      set_dispatch()), the call-back is queued and may run after the
+ *      completion. A handle armed for a group of requests follows this
+ *      request as one of the group; a handle that follows no request is
+ *      armed for this request, one that still follows as many requests as
+ *      it was armed for is refused (completion_busy).
+ * @param dacqh: pointer on a structure of type dacq_handle_t containing all
+ *      sensor relevant data; the data and status arrays must stay valid
+ *      until the request completes.
+ * @param completion: pointer on a completion handle, or nullptr.
+ * @return true if the request was queued, false otherwise.
+ */
+bool
+sdi12_dr::retrieve_async (dacq_handle_t* dacqh, dacq_completion* completion)
+{
+  bool result = false;
+  concurent_msg_t* pmsg;
+
+  if ((pmsg = reserve (dacqh)) != nullptr)
+    {
+      if (completion != nullptr && completion->attach (clock_) == false)
+        {
+          // the handle still follows other requests, they would be merged
+          release (pmsg);
+          error = &err_[completion_busy];
+        }
+      else
+        {
+          if (dacqh->status != nullptr)
+            {
+              memset (dacqh->status, STATUS_BIT_MISSING, dacqh->data_count);
+            }
+          pmsg->completion = completion;
+          pmsg->start = true;
+          // as soon as the bus is free; concurrent measurements are started
+          // first (one tick earlier), sequential ones fill their waiting
+          // time
+          pmsg->deadline = clock_->now ()
+              + (pmsg->sdih.method == sdi12_dr::concurrent ? 0 : 1);
+          submit (pmsg);
+          error = &err_[ok];
+          result = true;
+        }
+    }
+
+  return result;
+}
+
+/**
+ * @brief Allocate an entry for a request and mark the sensor as busy.
+ * @param dacqh: pointer on the request.
+ * @return pointer on the entry, or nullptr if the address is not valid,
+ *      the sensor is busy or all the entries are used.
+ */
+sdi12_dr::concurent_msg_t*
+sdi12_dr::reserve (dacq_handle_t* dacqh)
+{
   concurent_msg_t* pmsg = nullptr;
   sdi12_t* sdi = (sdi12_t*) dacqh->impl;
+  int index = addr_to_index (sdi->addr);
 
-  for (int i = 0; i < MAX_CONCURRENT_REQUESTS; i++)
+  if (index < 0)
+    {
+      error = &err_[invalid_address];
+    }
+  else
     {
-      if (msgs_[i].sdih.addr == static_cast<sdi12_t*> (dacqh->impl)->addr)
+      requests_mutex_.lock ();
+      if (busy_ & (1ULL << index))
         {
           // this sensor is already in a transaction, abort
           error = &err_[sensor_busy];
-          return result;
         }
+      else if ((pmsg = slots_.alloc ()) == nullptr)
+        {
+          error = &err_[too_many_requests];
+        }
+      else
+        {
+          busy_ |= 1ULL << index;
+        }
+      requests_mutex_.unlock ();
     }
 
-  // search for a free entry in the table
-  for (int i = 0; i < MAX_CONCURRENT_REQUESTS; i++)
+  if (pmsg != nullptr)
     {
-      if (msgs_[i].sdih.addr == 0)
+      // copy sensor data to the table
+      memcpy (&pmsg->dh, dacqh, sizeof(dacq_handle_t));
+      memcpy (&pmsg->sdih, sdi, sizeof(sdi12_t));
+      pmsg->dh.impl = &pmsg->sdih;      // update sensor handle
+      pmsg->completion = nullptr;
+      pmsg->planned = false;
+      pmsg->start = false;
+    }
+
+  return pmsg;
+}
+
+/**
+ * @brief Send the concurrent measurement command of a request; the bus
+ *      must be locked.
+ * @param pmsg: pointer on the request.
+ * @return true if successful, false otherwise.
+ */
+bool
+sdi12_dr::start_concurrent (concurent_msg_t* pmsg)
+{
+  int waiting_time;
+  uint16_t measurements;
+
+  if (start_measurement (&pmsg->sdih, waiting_time, measurements) == false)
+    {
+      return false;
+    }
+
+  // update the entry with ETA and number of expected values
+  pmsg->deadline = clock_->now () + waiting_time * 1000;
+  pmsg->ready_us = clock_->now_us () + waiting_time * 1000000ULL;
+  pmsg->dh.data_count = std::min (pmsg->dh.data_count, measurements);
+  return true;
+}
+
+/**
+ * @brief Queue a request for the collect thread.
+ * @param pmsg: pointer on the request.
+ */
+void
+sdi12_dr::submit (concurent_msg_t* pmsg)
+{
+  requests_mutex_.lock ();
+  pending_.push (pmsg);
+  requests_mutex_.unlock ();
+
+  // inform the collect task that a new entry is available; if a
+  // post is already pending, it will see this entry as well
+  sem_.post ();
+}
+
+/**
+ * @brief Remove the request with the nearest deadline from the queue, if
+ *      its deadline is reached.
+ * @param next: returns the nearest deadline, if no request is due.
+ * @return pointer on the request, or nullptr if none is due.
+ */
+sdi12_dr::concurent_msg_t*
+sdi12_dr::pop_ready (clock::timestamp_t& next)
+{
+  concurent_msg_t* pmsg;
+
+  requests_mutex_.lock ();
+  if ((pmsg = pending_.top ()) != nullptr)
+    {
+      if (pmsg->deadline <= clock_->now ())
+        {
+          pending_.pop ();
+        }
+      else
         {
-          pmsg = &msgs_[i];
-          break;    // found
+          next = pmsg->deadline;
+          pmsg = nullptr;
         }
     }
+  requests_mutex_.unlock ();
+
+  return pmsg;
+}
+
+/**
+ * @brief Check if there are queued requests.
+ */
+bool
+sdi12_dr::requests_pending (void)
+{
+  requests_mutex_.lock ();
+  bool result = pending_.size () > 0;
+  requests_mutex_.unlock ();
 
-  if (pmsg)
+  return result;
+}
+
+/**
+ * @brief Change the maximum number of concurrent requests; up to
+ *      MAX_CONCURRENT_REQUESTS the built-in storage is used, beyond that
+ *      the storage is allocated from the heap. It can only be changed while
+ *      no concurrent request is pending.
+ * @param count: maximum number of concurrent requests.
+ * @return true if successful, false otherwise.
+ */
+bool
+sdi12_dr::set_max_concurrent (size_t count)
+{
+  bool result = false;
+
+  if (clock_->timed_lock (mutex_, lock_timeout) == result::ok)
     {
-      // initiate a concurrent measurement
-      if (start_measurement (sdi, waiting_time, measurements) == true)
+      requests_mutex_.lock ();
+      if (slots_.used () > 0)
         {
-          // copy sensor data to the table
-          memcpy (&pmsg->dh, dacqh, sizeof(dacq_handle_t));
-          memcpy (&pmsg->sdih, sdi, sizeof(sdi12_t));
-
-          // update the entry with ETA and number of expected values
-          pmsg->response_delay = sysclock.now () + waiting_time * 1000;
-          pmsg->dh.data_count = std::min (dacqh->data_count, measurements);
+          // requests pending, or call-backs not yet dispatched
+          error = &err_[dacq_busy];
+        }
+      else if (count > sdi12_pool<concurent_msg_t>::max_capacity)
+        {
+          error = &err_[too_many_requests];
+        }
+      else
+        {
+          concurent_msg_t* msgs = msgs_;
+          concurent_msg_t** items = pending_items_;
 
-          // inform the collect task that a new entry is available
-          if (sem_.post () == result::ok)
+          if (count > MAX_CONCURRENT_REQUESTS)
             {
+              msgs = new (std::nothrow) concurent_msg_t[count];
+              items = new (std::nothrow) concurent_msg_t*[count];
+            }
+          if (msgs == nullptr || items == nullptr)
+            {
+              delete[] msgs;
+              delete[] items;
+              error = &err_[no_memory];
+            }
+          else
+            {
+              delete[] pool_msgs_;
+              delete[] pool_items_;
+              pool_msgs_ = msgs != msgs_ ? msgs : nullptr;
+              pool_items_ = items != pending_items_ ? items : nullptr;
+              slots_.reset (msgs, count);
+              pending_.reset (items, count);
+              error = &err_[ok];
               result = true;
             }
         }
+      requests_mutex_.unlock ();
+      mutex_.unlock ();
     }
   else
     {
-      error = &err_[too_many_requests];
+      error = &err_[dacq_busy];
     }
 
   return result;
 }
 
 /**
- * @brief Thread to handle asynchronous sensor data sampling.
+ * @brief Execute a request removed from the queue: collect the data of a
+ *      concurrent measurement, or, for a request queued by retrieve_async(),
+ *      send the measurement command (a concurrent measurement is queued
+ *      again until its data is ready) or execute a sequential retrieval.
+ *      The user call-back is dispatched, the completion handle completed
+ *      and the entry freed once the call-back was called; the bus must be
+ *      locked.
+ * @param pmsg: pointer on the request.
+ * @return true if successful (or if the concurrent measurement started),
+ *      false otherwise.
+ */
+bool
+sdi12_dr::deliver (concurent_msg_t* pmsg)
+{
+  bool result = false;
+  bool callback = false;
+
+  if (pmsg->start)
+    {
+      pmsg->start = false;
+      origin_ = clock_->now ();
+      if (pmsg->sdih.method != sdi12_dr::concurrent)
+        {
+          result = retrieve_sequential (&pmsg->dh);
+          callback = true;      // called on failure as well
+        }
+      else if (start_concurrent (pmsg) == true)
+        {
+          submit (pmsg);
+          return true;
+        }
+    }
+  else
+    {
+      sdi12_results::record_t* record =
+          results_ != nullptr ? results_->claim () : nullptr;
+      float* data = pmsg->dh.data;
+      uint8_t* status = pmsg->dh.status;
+
+      if (record != nullptr)
+        {
+          data = record->values;
+          status = record->status;
+          pmsg->dh.data_count = std::min (pmsg->dh.data_count,
+                                          (uint16_t) sdi12_results::max_values);
+        }
+      pmsg->sdih.method = (method_t) 'D';
+      if ((data == nullptr && pmsg->sdih.fixed == nullptr)
+          || status == nullptr)
+        {
+          error = &err_[no_memory];     // the ring is full, nowhere to go
+        }
+      else if (get_data (&pmsg->sdih, data,
+                         record != nullptr ? nullptr : pmsg->sdih.fixed,
+                         status, pmsg->dh.data_count) == true)
+        {
+          stamp (&pmsg->dh, pmsg->ready_us);
+          if (record != nullptr)
+            {
+              record->ready = pmsg->dh.ready;
+              record->received = pmsg->dh.received;
+              record->addr = pmsg->sdih.addr;
+              record->count = pmsg->dh.data_count;
+              results_->publish ();
+            }
+          result = callback = true;
+        }
+    }
+
+  // the entry may be freed by dispatch(), take what is still needed
+  dacq_completion* completion = pmsg->completion;
+  uint16_t count = result ? pmsg->dh.data_count : 0;
+
+  if (callback)
+    {
+      dispatch (&pmsg->dh, release_entry, pmsg);
+    }
+  else
+    {
+      release (pmsg);   // all done here, free entry
+    }
+
+  if (completion != nullptr)
+    {
+      completion->complete (result, error, count);
+    }
+
+  return result;
+}
+
+/**
+ * @brief Thread to handle asynchronous sensor data sampling. The pending
+ *      requests are kept in a heap ordered by their deadline, so the next
+ *      sensor to be read is always on top; the heap is accessed with the
+ *      requests mutex held, and a request is only removed from it with the
+ *      bus mutex held.
  * @param args: pointer on the class ("this").
  */
 void*
 sdi12_dr::collect (void* args)
 {
   sdi12_dr* self = static_cast<sdi12_dr*> (args);
-  semaphore_counting* sem = &self->sem_;
-  concurent_msg_t* pmsg = nullptr;
-  result_t result;
-  clock::duration_t timeout = 0xFFFFFFFF; // forever
-
-  memset (self->msgs_, 0, MAX_CONCURRENT_REQUESTS * sizeof(concurent_msg_t));
+  concurent_msg_t* pmsg;
+  clock::duration_t timeout = dacq_clock::forever;
 
   while (true)
     {
-      result = sem->timed_wait (timeout);
-      if (result != result::ok)
+      // wait for the nearest deadline, or for a new entry
+      if (timeout > 0)
         {
-          // if timeout, the first sensor in line is now ready
-          if (pmsg != nullptr)
-            {
-              self->mutex_.lock ();
-
-              // get sensor data
-              pmsg->sdih.method = (method_t) 'D';
-              if (self->get_data (&pmsg->sdih, pmsg->dh.data, pmsg->dh.status,
-                                  pmsg->dh.data_count) == true)
-                {
-                  pmsg->dh.impl = &pmsg->sdih;  // update sensor handle
-                  if (pmsg->dh.cb != nullptr)
-                    {
-                      pmsg->dh.cb (&pmsg->dh);  // user callback
-                    }
-                }
-              pmsg->sdih.addr = 0;
-              pmsg = nullptr;       // all done here, clear entry
-              self->mutex_.unlock ();
-            }
+          self->clock_->timed_wait (self->sem_, timeout);
         }
-      // otherwise we might have a new entry from the main thread
-      // search for the next sensor (if any) ready to deliver its data
-      clock::duration_t nearest_request = 0xFFFFFFFF;
-      pmsg = nullptr;
-      for (int i = 0; i < MAX_CONCURRENT_REQUESTS; i++)
+
+      self->clock_->timed_lock (self->mutex_, dacq_clock::forever);
+      clock::timestamp_t next = 0;
+      timeout = dacq_clock::forever;
+      if ((pmsg = self->pop_ready (next)) != nullptr)
         {
-          if (self->msgs_[i].sdih.addr != 0)
-            {
-              if (self->msgs_[i].response_delay < nearest_request)
-                {
-                  nearest_request = self->msgs_[i].response_delay;
-                  pmsg = &self->msgs_[i];
-                }
-            }
+          // the first sensor in line is ready
+          self->deliver (pmsg);
+          timeout = 0;          // the next one might be ready too
         }
-
-      // compute the timeout for the next wake-up
-      timeout = 0xFFFFFFFF;
-      if (pmsg != nullptr)
+      else if (next != 0)
         {
-          timeout =
-              pmsg->response_delay > sysclock.now () ?
-                  pmsg->response_delay - sysclock.now () : 0;
+          clock::timestamp_t now = self->clock_->now ();
+          timeout = next > now ?
+              std::min (next - now,
+                        (clock::timestamp_t) dacq_clock::forever - 1) :
+              0;
         }
+      self->flush_dump ();
+      self->mutex_.unlock ();
     }
 
   return nullptr;
@@ -32,12 +32,37 @@
 
 #include <cmsis-plus/rtos/os.h>
 #include <dacq.h>
-#include "uart-drv.h"
+#include "sdi-12-frame.h"
+#include "sdi-12-break.h"
+#include "dacq-clock.h"
+#include "dacq-completion.h"
+#include "dacq-dispatch.h"
+#include "sdi-12-heap.h"
+#include "sdi-12-pool.h"
+#include "sdi-12-results.h"
+#include "dacq-fixed.h"
+#include "sdi-12-trace.h"
+#include "sdi-12-stats.h"
+#include "sdi-12-binary.h"
+#include "sdi-12-schema.h"
+#include "sdi-12-retry.h"
 
 #ifndef SDI_BREAK_LEN
 #define SDI_BREAK_LEN 20        // milliseconds
 #endif
 
+#ifndef SDI_SR_GRACE
+#define SDI_SR_GRACE 500        // milliseconds
+#endif
+
+#ifndef SDI_SR_GRACE_MIN
+#define SDI_SR_GRACE_MIN 20     // milliseconds
+#endif
+
+#ifndef SDI_PROBE_TIMEOUT
+#define SDI_PROBE_TIMEOUT 25    // ms, 15 ms to start answering + 1 char
+#endif
+
 #ifndef MAX_CONCURRENT_REQUESTS
 #define MAX_CONCURRENT_REQUESTS 10
 #endif
@@ -50,6 +75,8 @@ public:
 
   sdi12_dr (const char* name);
 
+  sdi12_dr (dacq_transport& transport);
+
   ~sdi12_dr ();
 
   typedef enum
@@ -58,7 +85,9 @@ public:
     concurrent = 'C', //
     continuous = 'R', //
     verify = 'V',
-    data = 'D'
+    data = 'D',
+    high_volume_ascii = 'H', // SDI-12 1.4 "HA", up to 999 values
+    high_volume_binary = 'B' // SDI-12 1.4 "HB", binary data packets
   } method_t;
 
   typedef struct sdi12_
@@ -68,6 +97,11 @@ public:
     uint8_t index;
     bool use_crc;
     int16_t max_waiting;
+    bool strict_break = false;  // always send a break when the address
+                                // changes
+    dacq_fixed_t* fixed = nullptr;      // if not nullptr, the values are
+                                        // returned here, as sent, instead
+                                        // of in data
   } sdi12_t;
 
   void
@@ -86,6 +120,68 @@ public:
   bool
   retrieve (dacq_handle_t* dacqh) override;
 
+  bool
+  set_date (time_t date) override;
+
+  time_t
+  get_date (void) override;
+
+  bool
+  retrieve_many (dacq_handle_t* dacqh[], size_t count);
+
+  void
+  set_break_policy (sdi12_break_policy* policy);
+
+  void
+  set_retry_policy (sdi12_retry_policy* policy);
+
+  void
+  set_clock (dacq_clock* clock);
+
+  void
+  set_dispatch (dacq_dispatch* dispatch);
+
+  void
+  set_trace (sdi12_trace* trace);
+
+  void
+  set_stats (sdi12_stats* stats);
+
+  void
+  set_schema (sdi12_schema* schema);
+
+  bool
+  learn (sdi12_t* sdi);
+
+  bool
+  get_parameter (sdi12_t* sdi, uint16_t param, char* text, size_t len);
+
+  bool
+  discover (uint64_t& found, bool single = false);
+
+#if MAX_CONCURRENT_REQUESTS > 0
+  bool
+  retrieve_async (dacq_handle_t* dacqh, dacq_completion* completion = nullptr);
+
+  bool
+  set_max_concurrent (size_t count);
+
+  size_t
+  max_concurrent (void);
+
+  void
+  set_results (sdi12_results* results);
+#endif
+
+  static int
+  addr_to_index (char addr);
+
+  static char
+  index_to_addr (int index);
+
+  // number of valid SDI-12 addresses ('0'-'9', 'A'-'Z', 'a'-'z')
+  static constexpr int max_addresses = 62;
+
   // --------------------------------------------------------------------
 
 protected:
@@ -94,30 +190,83 @@ protected:
 
 private:
 
+  void
+  prepare (char addr, bool strict);
+
+  bool
+  probe (char addr);
+
   int
-  transaction (char* buff, size_t cmd_len, size_t len);
+  transaction (char* buff, size_t cmd_len, size_t len, bool strict = false,
+               sdi12_binary* packet = nullptr);
+
+  bool
+  retrieve_sequential (dacq_handle_t* dacqh);
+
+  void
+  dispatch (dacq_handle_t* dacqh, dacq_dispatch::release_t done = nullptr,
+            void* context = nullptr);
+
+  static size_t
+  next_request (dacq_handle_t* dacqh[], size_t count, size_t from,
+                bool concurrent);
 
   bool
-  start_measurement (sdi12_t* sdi, int& response_delay, uint8_t& measurements);
+  start_measurement (sdi12_t* sdi, int& response_delay, uint16_t& measurements);
 
   bool
   wait_for_service_request (sdi12_t* sdi, int response_delay);
 
   bool
-  get_data (sdi12_t* sdi, float* data, uint8_t* status, uint8_t& measurements);
+  get_data (sdi12_t* sdi, float* data, dacq_fixed_t* fixed, uint8_t* status,
+            uint16_t& measurements, uint16_t pages = 10);
+
+  bool
+  get_binary (sdi12_t* sdi, float* data, uint8_t* status,
+              uint16_t& measurements);
+
+  static size_t
+  put_index (char* buff, uint16_t index);
+
+  static size_t
+  measurement_command (sdi12_t* sdi, char* buff);
+
+  static bool
+  measurement_answer (const char* buff, int count, char addr, uint16_t& ttt,
+                      uint16_t& values);
+
+  int
+  rounds (char addr);
 
-  uint16_t
-  calc_crc (uint16_t initial, uint8_t* buff, uint16_t buff_len);
+  void
+  spare (char addr, int commands);
 
   void
   force_break (void);
 
+  uint64_t
+  wall_us (uint64_t us);
+
+  void
+  stamp (dacq_handle_t* dacqh, uint64_t ready);
+
+  void
+  record (uint64_t time, sdi12_trace::type_t type, char addr,
+          const void* data = nullptr, size_t length = 0, uint8_t aux = 0);
+
+  void
+  flush_dump (void);
+
   void
-  dump (const char* fmt, ...);
+  tally (char addr, sdi12_stats::counter_t counter);
+
+  // time source, declared before the collect thread that uses it
+  dacq_clock default_clock_;
+  dacq_clock* clock_ = &default_clock_;
 
 #if MAX_CONCURRENT_REQUESTS > 0
   bool
-  retrieve_concurrent (dacq_handle_t* dacqh);
+  retrieve_concurrent (dacq_handle_t* dacqh, bool planned = false);
 
   static void*
   collect (void* args);
@@ -126,10 +275,63 @@ private:
   {
     dacq_handle_t dh;
     sdi12_t sdih;
-    os::rtos::clock::timestamp_t response_delay;
+    os::rtos::clock::timestamp_t deadline;      // when the data is ready
+    uint64_t ready_us;  // the same, in µs, for the timestamps
+    uint16_t heap_index;
+    uint16_t next_free;
+    bool planned;       // started by retrieve_many()
+    bool start;         // queued by retrieve_async(), command not yet sent
+    dacq_completion* completion;
   } concurent_msg_t;
 
+  concurent_msg_t*
+  reserve (dacq_handle_t* dacqh);
+
+  bool
+  start_concurrent (concurent_msg_t* pmsg);
+
+  void
+  submit (concurent_msg_t* pmsg);
+
+  concurent_msg_t*
+  pop_ready (os::rtos::clock::timestamp_t& next);
+
+  bool
+  requests_pending (void);
+
+  bool
+  deliver (concurent_msg_t* pmsg);
+
+  void
+  release (concurent_msg_t* pmsg);
+
+  static void
+  release_entry (void* owner, void* context);
+
+  // built-in storage for MAX_CONCURRENT_REQUESTS requests
   concurent_msg_t msgs_[MAX_CONCURRENT_REQUESTS];
+  concurent_msg_t* pending_items_[MAX_CONCURRENT_REQUESTS];
+
+  // larger storage, allocated by set_max_concurrent()
+  concurent_msg_t* pool_msgs_ = nullptr;
+  concurent_msg_t** pool_items_ = nullptr;
+
+  // free requests, and pending requests ordered by deadline
+  sdi12_pool<concurent_msg_t> slots_
+    { msgs_, MAX_CONCURRENT_REQUESTS };
+  sdi12_heap<concurent_msg_t> pending_
+    { pending_items_, MAX_CONCURRENT_REQUESTS };
+
+  // driver-owned storage for the data of concurrent measurements, or nullptr
+  sdi12_results* results_ = nullptr;
+
+  // one bit per address (see addr_to_index()) with a pending request
+  uint64_t busy_ = 0;
+
+  // protects the requests table, the heap and the bitmap; it is only held
+  // for short periods, so that retrieve_async() never waits for the bus
+  os::rtos::mutex requests_mutex_
+    { "sdi12_rq" };
 
   os::rtos::semaphore_counting sem_
     { "sdi12_dr", 2, 0 };
@@ -138,10 +340,53 @@ private:
 
 #endif // MAX_CONCURRENT_REQUESTS > 0
 
-  char last_sdi_addr_ = '?';
+  char last_sdi_addr_ = 0;     // 0: line state unknown, a break is due
   os::rtos::clock::timestamp_t last_sdi_time_ = 0;
+
+  // decides when a break is needed
+  sdi12_break_policy default_break_policy_;
+  sdi12_break_policy* break_policy_ = &default_break_policy_;
+
+  // decides how often unanswered commands are repeated
+  sdi12_retry_policy default_retry_policy_;
+  sdi12_retry_policy* retry_policy_ = &default_retry_policy_;
+  // per address: duration of the last attempt that was not answered, in ms
+  uint16_t miss_ms_[max_addresses] = { };
   os::rtos::clock::timestamp_t origin_;
 
+  // queue of the call-backs to be called later, nullptr to call them at once
+  dacq_dispatch* dispatch_ = nullptr;
+
+  // bus timing, in µs of the clock: when the last answer was received, and
+  // when the last sequential measurement completed (service request or ETA)
+  uint64_t rx_end_us_ = 0;
+  uint64_t ready_us_ = 0;
+
+  // wall clock minus clock time, in µs (see set_date())
+  int64_t wall_offset_us_ = 0;
+
+  // per address: how long to wait for a service request after the announced
+  // time, in ms (0: not learned yet)
+  uint16_t sr_grace_[max_addresses] = { };
+  bool sr_missed_ = false;      // the last wait ended without service request
+
+  // incoming frame assembler
+  sdi12_frame rx_frame_;
+
+  // bus events recorder, installed by the user; without it, the events are
+  // recorded in the built-in ring if a dump function is set, and formatted
+  // for it after each transaction
+  sdi12_trace* trace_ = nullptr;
+  sdi12_trace dump_trace_;
+  uint32_t dump_high_ = 0;      // decoder state of the built-in ring
+  uint32_t dump_lost_ = 0;      // events lost by the ring, already reported
+
+  // per-sensor performance counters, or nullptr
+  sdi12_stats* stats_ = nullptr;
+
+  // measurements learned from the metadata commands, or nullptr
+  sdi12_schema* schema_ = nullptr;
+
   // transaction dump buffer, as the longest frame is 84 chars, it should be enough
   char dump_buffer_[128];
 
@@ -151,10 +396,7 @@ private:
   static constexpr uint8_t VERSION_PATCH = 4;
 
   // max 75 bytes values + 6 bytes address, CRC and CR/LF, word aligned
-  static constexpr int longest_sdi12_frame = 84;
-
-  // number of retries with break
-  static constexpr int retries_with_break = 3;
+  static constexpr int longest_sdi12_frame = sdi12_frame::max_length;
 
   // timeout to wait on an already running SDI-12 transaction (in seconds)
   static constexpr uint32_t lock_timeout = (2 * 1000 * one_ms);
@@ -170,9 +412,267 @@ sdi12_dr::get_version (uint8_t& version_major, uint8_t& version_minor,
   version_patch = VERSION_PATCH;
 }
 
+/**
+ * @brief Install a policy deciding when a break precedes a command.
+ * @param policy: pointer to the policy; if nullptr, the default
+ *      (specification driven) policy is restored.
+ */
+inline void
+sdi12_dr::set_break_policy (sdi12_break_policy* policy)
+{
+  break_policy_ = policy ? policy : &default_break_policy_;
+}
+
+/**
+ * @brief Install a policy deciding how often a command is repeated when
+ *      the sensor does not answer. Call it while the driver is idle.
+ * @param policy: pointer to the policy; if nullptr, the default (adaptive)
+ *      policy is restored.
+ */
+inline void
+sdi12_dr::set_retry_policy (sdi12_retry_policy* policy)
+{
+  retry_policy_ = policy ? policy : &default_retry_policy_;
+}
+
+/**
+ * @brief Install a queue for the user call-backs: instead of being called
+ *      with the bus locked, they are called by the thread draining the queue,
+ *      while the driver goes on with the next transaction. Call it while the
+ *      driver is idle.
+ * @param dispatch: pointer to the queue; if nullptr, the call-backs are
+ *      called at once again (default).
+ */
+inline void
+sdi12_dr::set_dispatch (dacq_dispatch* dispatch)
+{
+  dispatch_ = dispatch;
+}
+
+/**
+ * @brief Install a recorder for the bus events (commands, answers, breaks
+ *      and errors); the events are recorded in binary form, and formatted
+ *      off the hot path by the consumer of the recorder, or offline. Call
+ *      it while the driver is idle.
+ * @param trace: pointer to the recorder, or nullptr to stop recording (if
+ *      a dump function is set, the events are then formatted for it).
+ */
+inline void
+sdi12_dr::set_trace (sdi12_trace* trace)
+{
+  trace_ = trace;
+}
+
+/**
+ * @brief Install a table of per-sensor performance counters (transactions,
+ *      retries, breaks, errors, measurement times and latencies), e.g. to
+ *      find the sensors that slow the sweeps down. Call it while the driver
+ *      is idle.
+ * @param stats: pointer to the table, or nullptr to stop counting.
+ */
+inline void
+sdi12_dr::set_stats (sdi12_stats* stats)
+{
+  stats_ = stats;
+}
+
+/**
+ * @brief Install a cache of the measurements of the sensors, filled by
+ *      learn(). Call it while the driver is idle.
+ * @param schema: pointer to the cache, or nullptr to stop using it.
+ */
+inline void
+sdi12_dr::set_schema (sdi12_schema* schema)
+{
+  schema_ = schema;
+}
+
+/**
+ * @brief Increment a performance counter of a sensor, if counting.
+ */
+inline void
+sdi12_dr::tally (char addr, sdi12_stats::counter_t counter)
+{
+  if (stats_ != nullptr)
+    {
+      stats_->add (addr_to_index (addr), counter);
+    }
+}
+
+/**
+ * @brief Record a bus event, if a recorder is installed or a dump function
+ *      is set.
+ */
+inline void
+sdi12_dr::record (uint64_t time, sdi12_trace::type_t type, char addr,
+                  const void* data, size_t length, uint8_t aux)
+{
+  sdi12_trace* trace =
+      trace_ != nullptr ? trace_ : (dump_fn_ != nullptr ? &dump_trace_ : nullptr);
+
+  if (trace != nullptr)
+    {
+      trace->record (time, type, addr, data, length, aux);
+    }
+}
+
+/**
+ * @brief Convert an SDI-12 address to an index.
+ * @param addr: SDI-12 address.
+ * @return an index between 0 and max_addresses - 1, or -1 if the address
+ *      is not valid.
+ */
+inline int
+sdi12_dr::addr_to_index (char addr)
+{
+  if (addr >= '0' && addr <= '9')
+    {
+      return addr - '0';
+    }
+  if (addr >= 'A' && addr <= 'Z')
+    {
+      return addr - 'A' + 10;
+    }
+  if (addr >= 'a' && addr <= 'z')
+    {
+      return addr - 'a' + 36;
+    }
+  return -1;
+}
+
+/**
+ * @brief Convert an index to an SDI-12 address.
+ * @param index: index between 0 and max_addresses - 1.
+ * @return the SDI-12 address.
+ */
+inline char
+sdi12_dr::index_to_addr (int index)
+{
+  return index < 10 ? '0' + index :
+         index < 36 ? 'A' + index - 10 : 'a' + index - 36;
+}
+
+/**
+ * @brief Find the next request of a sweep to be started concurrently, or
+ *      the next one to be executed sequentially.
+ * @param dacqh: array of pointers on dacq_handle_t structures.
+ * @param count: number of elements in the array.
+ * @param from: index where the search starts.
+ * @param concurrent: true to find a concurrent request, false otherwise.
+ * @return the index of the request, or count if there is none.
+ */
+inline size_t
+sdi12_dr::next_request (dacq_handle_t* dacqh[], size_t count, size_t from,
+                        bool concurrent)
+{
+  while (from < count
+      && (MAX_CONCURRENT_REQUESTS > 0
+          && ((sdi12_t*) dacqh[from]->impl)->method == sdi12_dr::concurrent)
+          != concurrent)
+    {
+      from++;
+    }
+  return from;
+}
+
+#if MAX_CONCURRENT_REQUESTS > 0
+/**
+ * @brief Return the maximum number of concurrent requests.
+ */
+inline size_t
+sdi12_dr::max_concurrent (void)
+{
+  return slots_.capacity ();
+}
+
+/**
+ * @brief Install a ring for the data of concurrent measurements: the data
+ *      is stored in the ring, with the address and the time it was
+ *      received, instead of the data and status arrays of the request
+ *      (which may then be nullptr); the call-back only signals that a new
+ *      record is available. If the ring is full, the arrays of the request
+ *      are used, if any. Call it while the driver is idle.
+ * @param results: pointer to the ring, or nullptr to use the arrays of the
+ *      requests (default).
+ */
+inline void
+sdi12_dr::set_results (sdi12_results* results)
+{
+  results_ = results;
+}
+
+/**
+ * @brief Return a finished request to the pool.
+ */
+inline void
+sdi12_dr::release (concurent_msg_t* pmsg)
+{
+  requests_mutex_.lock ();
+  busy_ &= ~(1ULL << addr_to_index (pmsg->sdih.addr));
+  slots_.release (pmsg);
+  requests_mutex_.unlock ();
+}
+
+/**
+ * @brief Release function posted with a request whose call-back is deferred.
+ * @param owner: pointer on the driver.
+ * @param context: pointer on the request.
+ */
+inline void
+sdi12_dr::release_entry (void* owner, void* context)
+{
+  static_cast<sdi12_dr*> (owner)->release (
+      static_cast<concurent_msg_t*> (context));
+}
+#endif
+
+/**
+ * @brief Map a time of the clock to the wall clock.
+ * @param us: time in µs of the clock.
+ * @return the time in µs of the wall clock.
+ */
+inline uint64_t
+sdi12_dr::wall_us (uint64_t us)
+{
+  return us + wall_offset_us_;
+}
+
+/**
+ * @brief Return how many times a command to a sensor may be repeated after
+ *      a break, as decided by the retry policy.
+ */
+inline int
+sdi12_dr::rounds (char addr)
+{
+  int n = retry_policy_->rounds (addr_to_index (addr), clock_->now ());
+
+  n = n < 1 ? 1 : n;
+  spare (addr,
+         (sdi12_retry_policy::full_rounds - n)
+             * sdi12_retry_policy::full_attempts);
+  return n;
+}
+
+/**
+ * @brief Account for the commands the retry policy did not send, if
+ *      counting; each would have cost as much as the last unanswered
+ *      command to the same sensor.
+ */
+inline void
+sdi12_dr::spare (char addr, int commands)
+{
+  int index = addr_to_index (addr);
+
+  if (stats_ != nullptr && commands > 0 && index >= 0)
+    {
+      stats_->saved (index, commands, commands * miss_ms_[index]);
+    }
+}
+
 inline void
 sdi12_dr::force_break (void)
 {
+  last_sdi_addr_ = 0;
   last_sdi_time_ = 0;
 }
 
@@ -0,0 +1,229 @@
+/*
+ * sdi-12-frame.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_FRAME_H_
+#define SDI_12_FRAME_H_
+
+#include <stddef.h>
+#include <string.h>
+#include "sdi-12-crc.h"
+
+#ifndef SDI_RX_CHUNK
+#define SDI_RX_CHUNK 1          // bytes requested per read
+#endif
+
+#if defined (__cplusplus)
+
+/*
+ * Incremental assembler for SDI-12 answers. The tty driver reads directly
+ * into the frame buffer (see tail() and wanted()); each block of new bytes
+ * is then committed and scanned once, and the frame is complete as soon as
+ * the CR/LF pair has been seen, regardless of how the bytes were split
+ * between reads. Bytes received after the CR/LF are kept and can be used
+ * as the start of the next frame. The CRC is updated while the bytes are
+ * scanned, so it is already verified when the frame completes.
+ */
+class sdi12_frame
+{
+public:
+
+  // max 75 bytes values + 6 bytes address, CRC and CR/LF, word aligned
+  static constexpr size_t max_length = 84;
+
+  void
+  reset (void);
+
+  char*
+  tail (void);
+
+  size_t
+  wanted (void);
+
+  bool
+  commit (size_t count);
+
+  void
+  next (void);
+
+  bool
+  complete (void);
+
+  bool
+  full (void);
+
+  const char*
+  data (void);
+
+  size_t
+  length (void);
+
+  bool
+  crc_valid (void);
+
+private:
+
+  bool
+  scan (void);
+
+  char buff_[max_length];
+  size_t fill_ = 0;     // bytes in the buffer
+  size_t scan_ = 0;     // bytes already scanned
+  size_t end_ = 0;      // frame length including CR/LF, 0 if not complete
+  size_t crc_pos_ = 0;  // bytes already added to the CRC
+  uint16_t crc_ = 0;
+
+};
+
+/**
+ * @brief Discard all the bytes in the frame buffer.
+ */
+inline void
+sdi12_frame::reset (void)
+{
+  fill_ = scan_ = end_ = crc_pos_ = 0;
+  crc_ = 0;
+}
+
+/**
+ * @brief Return the position where the next received bytes must be stored.
+ */
+inline char*
+sdi12_frame::tail (void)
+{
+  return buff_ + fill_;
+}
+
+/**
+ * @brief Return how many bytes should be requested from the tty driver.
+ *      By default this is one byte, so that the frame completes the moment
+ *      the LF arrives, even with drivers that only return from read() when
+ *      the requested count is satisfied or the receive timeout expired.
+ */
+inline size_t
+sdi12_frame::wanted (void)
+{
+  size_t room = sizeof(buff_) - fill_;
+
+  return end_ ? 0 : (room < SDI_RX_CHUNK ? room : SDI_RX_CHUNK);
+}
+
+/**
+ * @brief Account for new bytes stored at tail() and scan them.
+ * @param count: number of bytes stored.
+ * @return true if the frame is now complete, false otherwise.
+ */
+inline bool
+sdi12_frame::commit (size_t count)
+{
+  fill_ += count;
+  return scan ();
+}
+
+/**
+ * @brief Drop the completed frame; the bytes received after it (if any)
+ *      become the start of the next frame.
+ */
+inline void
+sdi12_frame::next (void)
+{
+  if (end_)
+    {
+      fill_ -= end_;
+      memmove (buff_, buff_ + end_, fill_);
+      scan_ = end_ = crc_pos_ = 0;
+      crc_ = 0;
+      scan ();
+    }
+}
+
+inline bool
+sdi12_frame::complete (void)
+{
+  return end_ != 0;
+}
+
+/**
+ * @brief Check if the buffer overflowed without a complete frame.
+ */
+inline bool
+sdi12_frame::full (void)
+{
+  return end_ == 0 && fill_ == sizeof(buff_);
+}
+
+inline const char*
+sdi12_frame::data (void)
+{
+  return buff_;
+}
+
+inline size_t
+sdi12_frame::length (void)
+{
+  return end_;
+}
+
+/**
+ * @brief Check the CRC of a complete frame; the CRC is made of the three
+ *      characters preceding the CR/LF.
+ * @return true if the CRC is correct, false otherwise.
+ */
+inline bool
+sdi12_frame::crc_valid (void)
+{
+  return end_ >= 6 && sdi12_crc::from_ascii (buff_ + end_ - 5) == crc_;
+}
+
+inline bool
+sdi12_frame::scan (void)
+{
+  while (end_ == 0 && scan_ < fill_)
+    {
+      char c = buff_[scan_++];
+      if (c == '\n' && scan_ > 1 && buff_[scan_ - 2] == '\r')
+        {
+          end_ = scan_;
+        }
+      else if (c != '\r')
+        {
+          // the three characters before the CR/LF might be the CRC, so
+          // a byte is added to the CRC only after three more arrived
+          while (crc_pos_ + 3 < scan_)
+            {
+              crc_ = sdi12_crc::update (crc_, buff_[crc_pos_++]);
+            }
+        }
+    }
+
+  return end_ != 0;
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* SDI_12_FRAME_H_ */
@@ -0,0 +1,246 @@
+/*
+ * sdi-12-heap.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_HEAP_H_
+#define SDI_12_HEAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined (__cplusplus)
+
+/*
+ * Binary min-heap of pointers to entries, ordered by their 'deadline'
+ * member; the entry with the nearest deadline is always on top. Each entry
+ * keeps its position in the 'heap_index' member, so it can also be removed
+ * from the middle of the heap. Insertion and removal take O(log n), reading
+ * the top O(1). The storage for the pointers is provided by the user.
+ */
+template<typename T>
+  class sdi12_heap
+  {
+  public:
+
+    sdi12_heap (T** storage, size_t capacity);
+
+    void
+    reset (T** storage, size_t capacity);
+
+    bool
+    push (T* item);
+
+    T*
+    top (void);
+
+    T*
+    pop (void);
+
+    void
+    remove (T* item);
+
+    size_t
+    size (void);
+
+  private:
+
+    void
+    place (size_t i, T* item);
+
+    void
+    sift_up (size_t i);
+
+    void
+    sift_down (size_t i);
+
+    T** items_;
+    size_t capacity_;
+    size_t count_ = 0;
+
+  };
+
+/**
+ * @brief Constructor.
+ * @param storage: array of pointers used to store the heap.
+ * @param capacity: number of elements of the array.
+ */
+template<typename T>
+  inline
+  sdi12_heap<T>::sdi12_heap (T** storage, size_t capacity) :
+      items_
+        { storage }, //
+      capacity_
+        { capacity }
+  {
+  }
+
+/**
+ * @brief Replace the storage of the heap; the heap becomes empty.
+ * @param storage: array of pointers used to store the heap.
+ * @param capacity: number of elements of the array.
+ */
+template<typename T>
+  inline void
+  sdi12_heap<T>::reset (T** storage, size_t capacity)
+  {
+    items_ = storage;
+    capacity_ = capacity;
+    count_ = 0;
+  }
+
+/**
+ * @brief Insert an entry.
+ * @param item: pointer to the entry.
+ * @return true if successful, false if the heap is full.
+ */
+template<typename T>
+  inline bool
+  sdi12_heap<T>::push (T* item)
+  {
+    if (count_ == capacity_)
+      {
+        return false;
+      }
+    place (count_++, item);
+    sift_up (count_ - 1);
+
+    return true;
+  }
+
+/**
+ * @brief Return the entry with the nearest deadline, or nullptr if empty.
+ */
+template<typename T>
+  inline T*
+  sdi12_heap<T>::top (void)
+  {
+    return count_ ? items_[0] : nullptr;
+  }
+
+/**
+ * @brief Remove and return the entry with the nearest deadline.
+ * @return pointer to the entry, or nullptr if the heap is empty.
+ */
+template<typename T>
+  inline T*
+  sdi12_heap<T>::pop (void)
+  {
+    T* item = top ();
+
+    if (item != nullptr)
+      {
+        remove (item);
+      }
+    return item;
+  }
+
+/**
+ * @brief Remove an entry, wherever it is in the heap.
+ * @param item: pointer to the entry (it must be in the heap).
+ */
+template<typename T>
+  inline void
+  sdi12_heap<T>::remove (T* item)
+  {
+    size_t i = item->heap_index;
+    T* last = items_[--count_];
+
+    if (i < count_)
+      {
+        // fill the hole with the last entry and restore the order
+        place (i, last);
+        sift_up (i);
+        sift_down (last->heap_index);
+      }
+  }
+
+template<typename T>
+  inline size_t
+  sdi12_heap<T>::size (void)
+  {
+    return count_;
+  }
+
+template<typename T>
+  inline void
+  sdi12_heap<T>::place (size_t i, T* item)
+  {
+    items_[i] = item;
+    item->heap_index = i;
+  }
+
+template<typename T>
+  inline void
+  sdi12_heap<T>::sift_up (size_t i)
+  {
+    T* item = items_[i];
+
+    while (i > 0)
+      {
+        size_t parent = (i - 1) / 2;
+        if (items_[parent]->deadline <= item->deadline)
+          {
+            break;
+          }
+        place (i, items_[parent]);
+        i = parent;
+      }
+    place (i, item);
+  }
+
+template<typename T>
+  inline void
+  sdi12_heap<T>::sift_down (size_t i)
+  {
+    T* item = items_[i];
+
+    while (true)
+      {
+        size_t child = 2 * i + 1;
+        if (child >= count_)
+          {
+            break;
+          }
+        if (child + 1 < count_
+            && items_[child + 1]->deadline < items_[child]->deadline)
+          {
+            child++;
+          }
+        if (item->deadline <= items_[child]->deadline)
+          {
+            break;
+          }
+        place (i, items_[child]);
+        i = child;
+      }
+    place (i, item);
+  }
+
+#endif /* (__cplusplus) */
+
+#endif /* SDI_12_HEAP_H_ */
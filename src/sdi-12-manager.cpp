@@ -0,0 +1,184 @@
+/*
+ * sdi-12-manager.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+/*
+ * This file implements the coordination of several SDI-12 buses.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include "sdi-12-manager.h"
+
+#if MAX_CONCURRENT_REQUESTS > 0
+
+using namespace os;
+using namespace os::rtos;
+
+/**
+ * @brief Constructor.
+ * @param buses: array of pointers on the drivers of the buses.
+ * @param count: number of buses; at most SDI_MAX_BUSES are used.
+ */
+sdi12_manager::sdi12_manager (sdi12_dr* buses[], size_t count)
+{
+  buses_count_ = std::min (count, (size_t) SDI_MAX_BUSES);
+  for (size_t i = 0; i < buses_count_; i++)
+    {
+      buses_[i].dr = buses[i];
+      buses_[i].count = 0;
+      buses_[i].registered = 0;
+    }
+  trace::printf ("%s() %p\n", __func__, this);
+}
+
+/**
+ * @brief Register a sensor; a sensor is identified by its bus and its
+ *      address (the addr member of the sdi12_t structure of the handle).
+ * @param bus: index of the bus.
+ * @param dacqh: pointer on a structure of type dacq_handle_t containing all
+ *      sensor relevant data; it must stay valid while it is registered.
+ * @return true if successful, false if the bus or the address is not valid,
+ *      or a sensor with the same address is already registered on the bus.
+ */
+bool
+sdi12_manager::add (size_t bus, dacq::dacq_handle_t* dacqh)
+{
+  if (bus >= buses_count_)
+    {
+      return false;
+    }
+
+  bus_t* b = &buses_[bus];
+  int index = sdi12_dr::addr_to_index (
+      static_cast<sdi12_dr::sdi12_t*> (dacqh->impl)->addr);
+  if (index < 0 || (b->registered & (1ULL << index)))
+    {
+      return false;
+    }
+
+  b->sensors[b->count++] = dacqh;
+  b->registered |= 1ULL << index;
+
+  return true;
+}
+
+/**
+ * @brief Unregister a sensor.
+ * @param bus: index of the bus.
+ * @param addr: address of the sensor.
+ * @return true if successful, false if the sensor was not registered.
+ */
+bool
+sdi12_manager::remove (size_t bus, char addr)
+{
+  int index = sdi12_dr::addr_to_index (addr);
+
+  if (bus >= buses_count_ || index < 0
+      || (buses_[bus].registered & (1ULL << index)) == 0)
+    {
+      return false;
+    }
+
+  bus_t* b = &buses_[bus];
+  for (size_t i = 0; i < b->count; i++)
+    {
+      if (static_cast<sdi12_dr::sdi12_t*> (b->sensors[i]->impl)->addr == addr)
+        {
+          b->sensors[i] = b->sensors[--b->count];
+          break;
+        }
+    }
+  b->registered &= ~(1ULL << index);
+
+  return true;
+}
+
+/**
+ * @brief Start a sweep of all the registered sensors, on all buses in
+ *      parallel; the function does not block. The call-back of each sensor
+ *      is called from the collect thread of its bus; the completion handle
+ *      is done when all sensors were retrieved (or failed).
+ * @param done: pointer on the completion handle following the sweep.
+ * @return true if the sweep started, false if the handle still follows
+ *      a running sweep, or if the request table of a bus could not hold
+ *      all its sensors (the reason is in the error of the bus driver);
+ *      nothing is queued then.
+ */
+bool
+sdi12_manager::sweep (dacq_completion* done)
+{
+  size_t total = 0;
+
+  if (done->armed ())
+    {
+      return false;
+    }
+
+  for (size_t i = 0; i < buses_count_; i++)
+    {
+      bus_t* b = &buses_[i];
+      total += b->count;
+      // one entry per sensor, so that the whole bus is queued at once
+      if (b->dr->max_concurrent () < b->count
+          && b->dr->set_max_concurrent (b->count) == false)
+        {
+          return false;
+        }
+    }
+  done->arm (clock_, total);
+
+  for (size_t i = 0; i < buses_count_; i++)
+    {
+      bus_t* b = &buses_[i];
+      for (size_t j = 0; j < b->count; j++)
+        {
+          if (b->dr->retrieve_async (b->sensors[j], done) == false)
+            {
+              done->complete (false, b->dr->error, 0);
+            }
+        }
+    }
+
+  return true;
+}
+
+/**
+ * @brief Sweep all the registered sensors, on all buses in parallel, and
+ *      wait for the sweep to end.
+ * @param timeout: maximum time to wait, in ms.
+ * @return true if the data of all sensors was retrieved, false otherwise.
+ */
+bool
+sdi12_manager::run (clock::duration_t timeout)
+{
+  return sweep (&done_) && done_.wait (timeout) && done_.result ();
+}
+
+#endif // MAX_CONCURRENT_REQUESTS > 0
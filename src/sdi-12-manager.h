@@ -0,0 +1,132 @@
+/*
+ * sdi-12-manager.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_MANAGER_H_
+#define SDI_12_MANAGER_H_
+
+#include <cmsis-plus/rtos/os.h>
+#include "sdi-12-dr.h"
+#include "dacq-completion.h"
+
+#ifndef SDI_MAX_BUSES
+#define SDI_MAX_BUSES 4
+#endif
+
+#if defined (__cplusplus) && (MAX_CONCURRENT_REQUESTS > 0)
+
+/*
+ * Coordinates the acquisition on several SDI-12 buses, each with its own
+ * sdi12_dr instance (and tty). The sensors are registered by bus and
+ * address; a sweep queues the requests of all buses at once with
+ * retrieve_async(), so that the collect threads of the drivers work in
+ * parallel, each following its deadline heap (concurrent measurements are
+ * started first, sequential ones fill their waiting time, data is collected
+ * as it becomes ready). A single completion handle follows the whole sweep.
+ */
+class sdi12_manager
+{
+public:
+
+  sdi12_manager (sdi12_dr* buses[], size_t count);
+
+  bool
+  add (size_t bus, dacq::dacq_handle_t* dacqh);
+
+  bool
+  remove (size_t bus, char addr);
+
+  size_t
+  sensors (size_t bus);
+
+  size_t
+  buses (void);
+
+  bool
+  sweep (dacq_completion* done);
+
+  bool
+  run (os::rtos::clock::duration_t timeout = dacq_clock::forever);
+
+  void
+  set_clock (dacq_clock* clock);
+
+private:
+
+  typedef struct bus_
+  {
+    sdi12_dr* dr;
+    dacq::dacq_handle_t* sensors[sdi12_dr::max_addresses];
+    size_t count;
+    uint64_t registered;        // one bit per address (see addr_to_index())
+  } bus_t;
+
+  bus_t buses_[SDI_MAX_BUSES];
+  size_t buses_count_;
+
+  dacq_clock default_clock_;
+  dacq_clock* clock_ = &default_clock_;
+
+  // completion of the sweeps started by run()
+  dacq_completion done_;
+
+};
+
+/**
+ * @brief Return the number of sensors registered on a bus.
+ */
+inline size_t
+sdi12_manager::sensors (size_t bus)
+{
+  return bus < buses_count_ ? buses_[bus].count : 0;
+}
+
+/**
+ * @brief Return the number of buses.
+ */
+inline size_t
+sdi12_manager::buses (void)
+{
+  return buses_count_;
+}
+
+/**
+ * @brief Install the time source used to wait for the sweeps; it should be
+ *      the clock of the drivers.
+ * @param clock: pointer to the clock; if nullptr, the system clock is
+ *      restored.
+ */
+inline void
+sdi12_manager::set_clock (dacq_clock* clock)
+{
+  clock_ = clock ? clock : &default_clock_;
+}
+
+#endif /* (__cplusplus) && (MAX_CONCURRENT_REQUESTS > 0) */
+
+#endif /* SDI_12_MANAGER_H_ */
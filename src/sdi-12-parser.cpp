@@ -0,0 +1,110 @@
+/*
+ * sdi-12-parser.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#include "sdi-12-parser.h"
+
+/**
+ * @brief Parse the next value.
+ * @param mantissa: the value's digits, as a signed integer.
+ * @param exponent: the power of ten of the value (zero or negative).
+ * @return value if a value was parsed, end if there are no more values, or
+ *      error if the value is malformed; in the latter case position()
+ *      returns the offset of the offending character.
+ */
+sdi12_parser::token_t
+sdi12_parser::next (int32_t& mantissa, int8_t& exponent)
+{
+  if (p_ >= end_)
+    {
+      return end;
+    }
+
+  bool negative;
+  if (*p_ == '+' || *p_ == '-')
+    {
+      negative = *p_++ == '-';
+    }
+  else
+    {
+      return error;     // the sign is mandatory
+    }
+
+  int32_t m = 0;
+  int digits = 0;
+  int decimals = -1;
+
+  for (; p_ < end_ && *p_ != '+' && *p_ != '-'; p_++)
+    {
+      if (*p_ >= '0' && *p_ <= '9')
+        {
+          if (++digits > max_digits)
+            {
+              return error;
+            }
+          m = m * 10 + (*p_ - '0');
+          if (decimals >= 0)
+            {
+              decimals++;
+            }
+        }
+      else if (*p_ == '.' && decimals < 0)
+        {
+          decimals = 0;
+        }
+      else
+        {
+          return error; // not a digit or a second decimal point
+        }
+    }
+
+  if (digits == 0)
+    {
+      return error;
+    }
+
+  mantissa = negative ? -m : m;
+  exponent = decimals > 0 ? -decimals : 0;
+
+  return value;
+}
+
+/**
+ * @brief Convert a value to float. Both the mantissa (at most seven digits)
+ *      and the power of ten are exactly representable, so the result of the
+ *      single division is correctly rounded.
+ */
+float
+sdi12_parser::to_float (int32_t mantissa, int8_t exponent)
+{
+  static const float powers[] =
+    { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f };
+
+  return exponent < 0 ?
+      (float) mantissa / powers[-exponent] : (float) mantissa;
+}
@@ -0,0 +1,97 @@
+/*
+ * sdi-12-parser.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_PARSER_H_
+#define SDI_12_PARSER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined (__cplusplus)
+
+/*
+ * Tokenizer for the values returned by the SDI-12 "D" and "R" commands.
+ * A value consists of a mandatory sign, one to seven digits and an optional
+ * decimal point; the values follow each other without separators. Each
+ * value is returned as an integer mantissa and a decimal exponent (the
+ * number of digits after the decimal point, negated), in a single pass
+ * and without calling the C library.
+ */
+class sdi12_parser
+{
+public:
+
+  typedef enum
+  {
+    value,      // a value was returned
+    end,        // no more values
+    error,      // malformed value, see position()
+  } token_t;
+
+  sdi12_parser (const char* begin, const char* end);
+
+  token_t
+  next (int32_t& mantissa, int8_t& exponent);
+
+  size_t
+  position (void);
+
+  static float
+  to_float (int32_t mantissa, int8_t exponent);
+
+  // max number of digits of an SDI-12 value
+  static constexpr int max_digits = 7;
+
+private:
+
+  const char* begin_;
+  const char* end_;
+  const char* p_;
+
+};
+
+inline
+sdi12_parser::sdi12_parser (const char* begin, const char* end) :
+    begin_ (begin), end_ (end), p_ (begin)
+{
+}
+
+/**
+ * @brief Return the offset of the next character to parse; after an
+ *      error, the offset of the offending character.
+ */
+inline size_t
+sdi12_parser::position (void)
+{
+  return p_ - begin_;
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* SDI_12_PARSER_H_ */
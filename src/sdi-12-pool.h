@@ -0,0 +1,159 @@
+/*
+ * sdi-12-pool.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_POOL_H_
+#define SDI_12_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined (__cplusplus)
+
+/*
+ * A pool of entries with a free list threaded through their 'next_free'
+ * member: allocation and release take O(1). The storage is provided by the
+ * user and can be replaced at runtime with reset(), while no entry is in
+ * use.
+ */
+template<typename T>
+  class sdi12_pool
+  {
+  public:
+
+    sdi12_pool (T* storage, size_t capacity);
+
+    void
+    reset (T* storage, size_t capacity);
+
+    T*
+    alloc (void);
+
+    void
+    release (T* item);
+
+    size_t
+    capacity (void);
+
+    size_t
+    used (void);
+
+    // largest supported capacity (0xFFFF marks the end of the free list)
+    static constexpr size_t max_capacity = 0xFFFE;
+
+  private:
+
+    static constexpr uint16_t none = 0xFFFF;
+
+    T* items_;
+    size_t capacity_;
+    size_t used_;
+    uint16_t free_;     // first free entry, or none
+
+  };
+
+/**
+ * @brief Constructor.
+ * @param storage: array of entries.
+ * @param capacity: number of entries of the array.
+ */
+template<typename T>
+  inline
+  sdi12_pool<T>::sdi12_pool (T* storage, size_t capacity)
+  {
+    reset (storage, capacity);
+  }
+
+/**
+ * @brief Replace the storage of the pool; all entries become free.
+ * @param storage: array of entries.
+ * @param capacity: number of entries of the array (at most max_capacity).
+ */
+template<typename T>
+  inline void
+  sdi12_pool<T>::reset (T* storage, size_t capacity)
+  {
+    items_ = storage;
+    capacity_ = capacity;
+    used_ = 0;
+    free_ = capacity ? 0 : none;
+    for (size_t i = 0; i < capacity; i++)
+      {
+        items_[i].next_free = (i + 1 < capacity) ? i + 1 : none;
+      }
+  }
+
+/**
+ * @brief Allocate an entry.
+ * @return pointer to the entry, or nullptr if all entries are in use.
+ */
+template<typename T>
+  inline T*
+  sdi12_pool<T>::alloc (void)
+  {
+    if (free_ == none)
+      {
+        return nullptr;
+      }
+    T* item = &items_[free_];
+    free_ = item->next_free;
+    used_++;
+
+    return item;
+  }
+
+/**
+ * @brief Return an entry to the pool.
+ * @param item: pointer to an entry allocated from this pool.
+ */
+template<typename T>
+  inline void
+  sdi12_pool<T>::release (T* item)
+  {
+    item->next_free = free_;
+    free_ = item - items_;
+    used_--;
+  }
+
+template<typename T>
+  inline size_t
+  sdi12_pool<T>::capacity (void)
+  {
+    return capacity_;
+  }
+
+template<typename T>
+  inline size_t
+  sdi12_pool<T>::used (void)
+  {
+    return used_;
+  }
+
+#endif /* (__cplusplus) */
+
+#endif /* SDI_12_POOL_H_ */
@@ -0,0 +1,183 @@
+/*
+ * sdi-12-results.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_RESULTS_H_
+#define SDI_12_RESULTS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <cmsis-plus/rtos/os.h>
+
+#ifndef SDI_RESULT_RING
+#define SDI_RESULT_RING 16      // records, a power of 2
+#endif
+
+#ifndef SDI_RESULT_VALUES
+#define SDI_RESULT_VALUES 20    // values per record
+#endif
+
+#if defined (__cplusplus)
+
+/*
+ * Ring of result records, owned by the driver, for the data of concurrent
+ * measurements (see sdi12_dr::set_results()); the timestamps are the ones
+ * of the handles (see sdi12_dr::set_date()). There is one producer, the
+ * thread holding the bus, and one consumer, which can drain the records
+ * in batches without any lock: the producer fills the record returned by
+ * claim() and makes it visible with publish(), the consumer reads the
+ * records from front() and frees them with pop(). If the ring is full,
+ * claim() fails and the overflow is counted.
+ */
+class sdi12_results
+{
+public:
+
+  typedef struct record_
+  {
+    uint64_t ready;             // when the measurement completed, in µs
+    uint64_t received;          // when the data was received, in µs
+    char addr;                  // sensor address
+    uint16_t count;             // number of values
+    float values[SDI_RESULT_VALUES];
+    uint8_t status[SDI_RESULT_VALUES];
+  } record_t;
+
+  static constexpr size_t capacity = SDI_RESULT_RING;
+  static constexpr size_t max_values = SDI_RESULT_VALUES;
+
+  static_assert((capacity & (capacity - 1)) == 0,
+      "SDI_RESULT_RING must be a power of 2");
+
+  // producer
+
+  record_t*
+  claim (void);
+
+  void
+  publish (void);
+
+  // consumer
+
+  size_t
+  available (void);
+
+  record_t*
+  front (size_t i = 0);
+
+  void
+  pop (size_t count = 1);
+
+  uint32_t
+  overflows (void);
+
+private:
+
+  record_t records_[SDI_RESULT_RING];
+  std::atomic<uint32_t> head_
+    { 0 };              // next record to be read, written by the consumer
+  std::atomic<uint32_t> tail_
+    { 0 };              // next record to be written, written by the producer
+  std::atomic<uint32_t> overflows_
+    { 0 };
+
+};
+
+/**
+ * @brief Get the record to be filled next.
+ * @return pointer on the record, or nullptr if the ring is full.
+ */
+inline sdi12_results::record_t*
+sdi12_results::claim (void)
+{
+  uint32_t tail = tail_.load (std::memory_order_relaxed);
+
+  if (tail - head_.load (std::memory_order_acquire) >= capacity)
+    {
+      overflows_.fetch_add (1, std::memory_order_relaxed);
+      return nullptr;
+    }
+  return &records_[tail & (capacity - 1)];
+}
+
+/**
+ * @brief Make the record returned by claim() visible to the consumer.
+ */
+inline void
+sdi12_results::publish (void)
+{
+  tail_.store (tail_.load (std::memory_order_relaxed) + 1,
+               std::memory_order_release);
+}
+
+/**
+ * @brief Return the number of records ready to be read.
+ */
+inline size_t
+sdi12_results::available (void)
+{
+  return tail_.load (std::memory_order_acquire)
+      - head_.load (std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get a record ready to be read.
+ * @param i: index of the record, less than available(); 0 is the oldest.
+ * @return pointer on the record; it is valid until it is popped.
+ */
+inline sdi12_results::record_t*
+sdi12_results::front (size_t i)
+{
+  return &records_[(head_.load (std::memory_order_relaxed) + i)
+      & (capacity - 1)];
+}
+
+/**
+ * @brief Free the oldest records, once they were read.
+ * @param count: number of records, at most available().
+ */
+inline void
+sdi12_results::pop (size_t count)
+{
+  head_.store (head_.load (std::memory_order_relaxed) + count,
+               std::memory_order_release);
+}
+
+/**
+ * @brief Return the number of results lost because the ring was full.
+ */
+inline uint32_t
+sdi12_results::overflows (void)
+{
+  return overflows_.load (std::memory_order_relaxed);
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* SDI_12_RESULTS_H_ */
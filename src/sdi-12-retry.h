@@ -0,0 +1,201 @@
+/*
+ * sdi-12-retry.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_RETRY_H_
+#define SDI_12_RETRY_H_
+
+#include <stdint.h>
+#include <cmsis-plus/rtos/os.h>
+
+#ifndef SDI_RETRY_DEAD
+#define SDI_RETRY_DEAD 3        // transactions without answer
+#endif
+
+#ifndef SDI_RETRY_BACKOFF
+#define SDI_RETRY_BACKOFF 1000  // milliseconds
+#endif
+
+#ifndef SDI_RETRY_BACKOFF_MAX
+#define SDI_RETRY_BACKOFF_MAX 60000     // milliseconds
+#endif
+
+#if defined (__cplusplus)
+
+/*
+ * Decides how often a command is repeated when a sensor does not answer.
+ * A command is sent up to full_attempts times in a transaction, and a
+ * transaction is repeated, after a break, up to full_rounds times. Sensors
+ * that answered recently keep this full budget. After SDI_RETRY_DEAD
+ * consecutive transactions without answer, the sensor is considered dead:
+ * its commands are not sent at all for SDI_RETRY_BACKOFF ms, then a single
+ * attempt is made; each failed attempt doubles the period, up to
+ * SDI_RETRY_BACKOFF_MAX ms. Any answer restores the full budget. The
+ * sensors are identified by the index of their address (see
+ * sdi12_dr::addr_to_index()); other indexes (e.g. for the "?!" wildcard)
+ * always get the full budget. Derive from this class to implement other
+ * policies and install them with sdi12_dr::set_retry_policy(); as the
+ * state is per address, a policy must not be shared between buses.
+ */
+class sdi12_retry_policy
+{
+public:
+
+  virtual
+  ~sdi12_retry_policy () = default;
+
+  virtual int
+  rounds (int index, os::rtos::clock::timestamp_t now);
+
+  virtual int
+  attempts (int index, os::rtos::clock::timestamp_t now);
+
+  virtual void
+  result (int index, bool answered, os::rtos::clock::timestamp_t now);
+
+  void
+  reset (void);
+
+  static constexpr int full_rounds = 3;
+  static constexpr int full_attempts = 3;
+  static constexpr int entries = 62;
+
+protected:
+
+  bool
+  dead (int index);
+
+private:
+
+  typedef struct entry_
+  {
+    uint8_t failures;   // consecutive transactions without answer
+    uint8_t backoff;    // the backoff period is SDI_RETRY_BACKOFF << backoff
+    uint32_t until;     // no attempt before this time (ms, wraps)
+  } entry_t;
+
+  entry_t entries_[entries] = { };
+
+};
+
+/**
+ * @brief Check if a sensor stopped answering.
+ * @param index: index of the sensor's address.
+ */
+inline bool
+sdi12_retry_policy::dead (int index)
+{
+  return index >= 0 && index < entries
+      && entries_[index].failures >= SDI_RETRY_DEAD;
+}
+
+/**
+ * @brief Return how many times a command may be repeated after a break.
+ * @param index: index of the sensor's address.
+ * @param now: current time, in ms.
+ * @return the number of transactions, at least 1.
+ */
+inline int
+sdi12_retry_policy::rounds (int index, os::rtos::clock::timestamp_t now)
+{
+  (void) now;
+  return dead (index) ? 1 : full_rounds;
+}
+
+/**
+ * @brief Return how many times a command may be sent in a transaction.
+ * @param index: index of the sensor's address.
+ * @param now: current time, in ms.
+ * @return the number of attempts; 0 if the command must not be sent.
+ */
+inline int
+sdi12_retry_policy::attempts (int index, os::rtos::clock::timestamp_t now)
+{
+  if (dead (index) == false)
+    {
+      return full_attempts;
+    }
+  return (int32_t) ((uint32_t) now - entries_[index].until) < 0 ? 0 : 1;
+}
+
+/**
+ * @brief Account for the outcome of a transaction.
+ * @param index: index of the sensor's address.
+ * @param answered: true if the sensor answered.
+ * @param now: current time, in ms.
+ */
+inline void
+sdi12_retry_policy::result (int index, bool answered,
+                            os::rtos::clock::timestamp_t now)
+{
+  if (index < 0 || index >= entries)
+    {
+      return;
+    }
+
+  entry_t* e = &entries_[index];
+  if (answered)
+    {
+      e->failures = 0;
+      e->backoff = 0;
+    }
+  else if (e->failures < SDI_RETRY_DEAD)
+    {
+      if (++e->failures == SDI_RETRY_DEAD)
+        {
+          e->until = (uint32_t) now + SDI_RETRY_BACKOFF;
+        }
+    }
+  else
+    {
+      // a probe of a dead sensor failed: wait twice as long
+      if (((uint32_t) SDI_RETRY_BACKOFF << e->backoff) < SDI_RETRY_BACKOFF_MAX)
+        {
+          e->backoff++;
+        }
+      uint32_t period = (uint32_t) SDI_RETRY_BACKOFF << e->backoff;
+      e->until = (uint32_t) now
+          + (period < SDI_RETRY_BACKOFF_MAX ? period : SDI_RETRY_BACKOFF_MAX);
+    }
+}
+
+/**
+ * @brief Forget the history of all the sensors.
+ */
+inline void
+sdi12_retry_policy::reset (void)
+{
+  for (entry_t& e : entries_)
+    {
+      e = { };
+    }
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* SDI_12_RETRY_H_ */
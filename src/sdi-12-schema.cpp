@@ -0,0 +1,268 @@
+/*
+ * sdi-12-schema.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#include <string.h>
+#include "sdi-12-schema.h"
+#include "sdi-12-crc.h"
+
+// blob layout: magic, version, number of entries, entries, CRC-16
+static constexpr uint8_t magic[4] =
+  { 'S', 'D', 'I', 'S' };
+static constexpr uint8_t version = 1;
+static constexpr size_t entry_size = 12;
+
+/**
+ * @brief Find the entry of a measurement; the table must be locked.
+ */
+sdi12_schema::entry_t*
+sdi12_schema::lookup (char addr, char method, uint8_t index)
+{
+  for (size_t i = 0; i < count_; i++)
+    {
+      if (entries_[i].addr == addr && entries_[i].method == method
+          && entries_[i].index == index)
+        {
+          return &entries_[i];
+        }
+    }
+  return nullptr;
+}
+
+/**
+ * @brief Look up the description of a measurement.
+ * @param addr: sensor's address.
+ * @param method: measurement method (see sdi12_dr::method_t).
+ * @param index: additional measurement index.
+ * @param entry: returns a copy of the entry.
+ * @return true if the measurement is known, false otherwise.
+ */
+bool
+sdi12_schema::find (char addr, char method, uint8_t index, entry_t& entry)
+{
+  mutex_.lock ();
+  entry_t* e = lookup (addr, method, index);
+  if (e != nullptr)
+    {
+      entry = *e;
+    }
+  mutex_.unlock ();
+
+  return e != nullptr;
+}
+
+/**
+ * @brief Add the description of a measurement, or replace it if already
+ *      known.
+ * @param entry: the description.
+ * @return true if successful, false if the cache is full.
+ */
+bool
+sdi12_schema::store (const entry_t& entry)
+{
+  bool result = true;
+
+  mutex_.lock ();
+  entry_t* e = lookup (entry.addr, entry.method, entry.index);
+  if (e == nullptr && count_ < capacity)
+    {
+      e = &entries_[count_++];
+    }
+  if (e != nullptr)
+    {
+      *e = entry;
+    }
+  else
+    {
+      result = false;
+    }
+  mutex_.unlock ();
+
+  return result;
+}
+
+/**
+ * @brief Check that the entries of an address belong to the sensor
+ *      currently answering there; if not, they are dropped.
+ * @param addr: sensor's address.
+ * @param identity: hash of the sensor's identification string.
+ * @return true if the entries of the address (if any) are still valid,
+ *      false if they were dropped.
+ */
+bool
+sdi12_schema::check (char addr, uint32_t identity)
+{
+  bool result = true;
+
+  mutex_.lock ();
+  for (size_t i = 0; i < count_; i++)
+    {
+      if (entries_[i].addr == addr && entries_[i].identity != identity)
+        {
+          result = false;
+        }
+    }
+  mutex_.unlock ();
+
+  if (result == false)
+    {
+      forget (addr);
+    }
+
+  return result;
+}
+
+/**
+ * @brief Drop all the entries of an address.
+ */
+void
+sdi12_schema::forget (char addr)
+{
+  mutex_.lock ();
+  size_t j = 0;
+  for (size_t i = 0; i < count_; i++)
+    {
+      if (entries_[i].addr != addr)
+        {
+          entries_[j++] = entries_[i];
+        }
+    }
+  count_ = j;
+  mutex_.unlock ();
+}
+
+/**
+ * @brief Serialize the cache, in a layout independent of the platform
+ *      (integers least significant byte first).
+ * @param blob: where the cache is stored.
+ * @param len: size of the blob; blob_size is always enough.
+ * @return the number of bytes stored, or 0 if the blob is too small.
+ */
+size_t
+sdi12_schema::save (uint8_t* blob, size_t len)
+{
+  mutex_.lock ();
+  size_t n = 8 + count_ * entry_size + 2;
+  if (n <= len)
+    {
+      memcpy (blob, magic, sizeof(magic));
+      blob[4] = version;
+      blob[5] = count_;
+      blob[6] = blob[7] = 0;
+      uint8_t* p = blob + 8;
+      for (size_t i = 0; i < count_; i++, p += entry_size)
+        {
+          const entry_t& e = entries_[i];
+          p[0] = e.addr;
+          p[1] = e.method;
+          p[2] = e.index;
+          p[3] = 0;
+          p[4] = e.values;
+          p[5] = e.values >> 8;
+          p[6] = e.ttt;
+          p[7] = e.ttt >> 8;
+          for (int k = 0; k < 4; k++)
+            {
+              p[8 + k] = e.identity >> (8 * k);
+            }
+        }
+      uint16_t crc = sdi12_crc::compute (0, blob, n - 2);
+      p[0] = crc;
+      p[1] = crc >> 8;
+    }
+  else
+    {
+      n = 0;
+    }
+  mutex_.unlock ();
+
+  return n;
+}
+
+/**
+ * @brief Replace the cache with a saved one.
+ * @param blob: the blob returned by save().
+ * @param len: size of the blob.
+ * @return true if successful, false if the blob is not valid; the cache is
+ *      then left unchanged.
+ */
+bool
+sdi12_schema::load (const uint8_t* blob, size_t len)
+{
+  if (len < 10 || memcmp (blob, magic, sizeof(magic)) != 0
+      || blob[4] != version || blob[5] > capacity)
+    {
+      return false;
+    }
+  size_t n = 8 + blob[5] * entry_size + 2;
+  if (len < n
+      || sdi12_crc::compute (0, blob, n - 2)
+          != (blob[n - 2] | (blob[n - 1] << 8)))
+    {
+      return false;
+    }
+
+  mutex_.lock ();
+  count_ = blob[5];
+  const uint8_t* p = blob + 8;
+  for (size_t i = 0; i < count_; i++, p += entry_size)
+    {
+      entry_t& e = entries_[i];
+      e.addr = p[0];
+      e.method = p[1];
+      e.index = p[2];
+      e.values = p[4] | (p[5] << 8);
+      e.ttt = p[6] | (p[7] << 8);
+      e.identity = 0;
+      for (int k = 0; k < 4; k++)
+        {
+          e.identity |= (uint32_t) p[8 + k] << (8 * k);
+        }
+    }
+  mutex_.unlock ();
+
+  return true;
+}
+
+/**
+ * @brief Hash an identification string (FNV-1a).
+ * @param info: the identification string, without the address (as returned
+ *      by get_info()); it ends at the null terminator or at the CR.
+ * @return the hash.
+ */
+uint32_t
+sdi12_schema::identity (const char* info)
+{
+  uint32_t h = 2166136261u;
+
+  for (; *info && *info != '\r'; info++)
+    {
+      h = (h ^ (uint8_t) *info) * 16777619u;
+    }
+  return h;
+}
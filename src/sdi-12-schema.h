@@ -0,0 +1,117 @@
+/*
+ * sdi-12-schema.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_SCHEMA_H_
+#define SDI_12_SCHEMA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cmsis-plus/rtos/os.h>
+
+#ifndef SDI_SCHEMA_ENTRIES
+#define SDI_SCHEMA_ENTRIES 32   // measurements described in a schema cache
+#endif
+
+#if defined (__cplusplus)
+
+/*
+ * Cache of the measurements of the sensors on a bus, as learned from the
+ * SDI-12 1.4 metadata commands (see sdi12_dr::learn()): for each address
+ * and measurement command (method and index, with or without CRC), the
+ * number of values and the measurement time.
+ * The entries are tagged with a hash of the identification string of the
+ * sensor (aI!), so that the entries of a sensor replaced by another one are
+ * dropped. The cache can be saved to a blob (e.g. in flash) and loaded
+ * after a reboot; the blob is checked with a CRC.
+ */
+class sdi12_schema
+{
+public:
+
+  typedef struct entry_
+  {
+    char addr;
+    char method;        // sdi12_dr::method_t
+    uint8_t index;      // additional measurement index
+    uint16_t values;    // number of values returned by the measurement
+    uint16_t ttt;       // measurement time, in seconds
+    uint32_t identity;  // hash of the identification string
+  } entry_t;
+
+  static constexpr size_t capacity = SDI_SCHEMA_ENTRIES;
+
+  // size of a blob holding all the entries
+  static constexpr size_t blob_size = 8 + capacity * 12 + 2;
+
+  bool
+  find (char addr, char method, uint8_t index, entry_t& entry);
+
+  bool
+  store (const entry_t& entry);
+
+  bool
+  check (char addr, uint32_t identity);
+
+  void
+  forget (char addr);
+
+  size_t
+  size (void);
+
+  size_t
+  save (uint8_t* blob, size_t len);
+
+  bool
+  load (const uint8_t* blob, size_t len);
+
+  static uint32_t
+  identity (const char* info);
+
+private:
+
+  entry_t*
+  lookup (char addr, char method, uint8_t index);
+
+  entry_t entries_[capacity];
+  size_t count_ = 0;
+
+  os::rtos::mutex mutex_
+    { "sdi12_sc" };
+
+};
+
+inline size_t
+sdi12_schema::size (void)
+{
+  return count_;
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* SDI_12_SCHEMA_H_ */
@@ -0,0 +1,296 @@
+/*
+ * sdi-12-stats.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_STATS_H_
+#define SDI_12_STATS_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <cmsis-plus/rtos/os.h>
+
+#ifndef SDI_STATS_BUCKETS
+#define SDI_STATS_BUCKETS 16    // latency histogram buckets
+#endif
+
+#if defined (__cplusplus)
+
+/*
+ * Per-sensor performance counters, updated by the driver (see
+ * sdi12_dr::set_stats()); the sensors are identified by the index of
+ * their address (see sdi12_dr::addr_to_index()). Besides the error
+ * counters, the table keeps the announced and the actual measurement
+ * times, the bus time saved by the retry policy, and two latency
+ * histograms with logarithmic buckets: bucket 0 counts latencies below
+ * 1 ms, bucket i (i > 0) latencies from 2^(i-1) to 2^i - 1 ms, and the
+ * last bucket all longer ones. The entries can be
+ * copied (and cleared) at any time with snapshot(); active() tells which
+ * entries were updated since they were cleared, so that exporting the
+ * table periodically only costs the copy of the sensors on the bus.
+ */
+class sdi12_stats
+{
+public:
+
+  typedef enum
+  {
+    transactions,       // commands sent, repetitions excluded
+    retries,            // commands repeated, as no answer was received
+    breaks,             // breaks sent before a command to this sensor
+    timeouts,           // commands without answer, repetitions included
+    unexpected,         // answers too short or from another sensor
+    crc_errors,         // answers with a wrong CRC
+    parse_errors,       // answers with malformed values
+    sr_missing,         // measurements without service request
+    skipped,            // commands not sent, as the retry policy backs off
+    counters
+  } counter_t;
+
+  typedef struct entry_
+  {
+    uint32_t count[counters];
+    uint32_t responses;         // measurements with a service request
+    uint64_t announced_ms;      // sum of the announced measurement times
+    uint64_t actual_ms;         // sum of the times to the service requests
+    uint64_t saved_ms;          // bus time saved by the retry policy
+    // time from the end of a command to the end of its answer
+    uint32_t answer[SDI_STATS_BUCKETS];
+    // time from the end of a measurement to the data received
+    uint32_t collect[SDI_STATS_BUCKETS];
+  } entry_t;
+
+  static constexpr int entries = 62;
+  static constexpr int buckets = SDI_STATS_BUCKETS;
+
+  // updated by the driver
+
+  void
+  add (int index, counter_t counter);
+
+  void
+  response (int index, uint32_t announced_ms, uint32_t actual_ms);
+
+  void
+  answer (int index, uint32_t ms);
+
+  void
+  collect (int index, uint32_t ms);
+
+  void
+  saved (int index, uint32_t commands, uint32_t ms);
+
+  // export
+
+  uint64_t
+  active (void);
+
+  bool
+  snapshot (int index, entry_t& entry, bool clear = false);
+
+  void
+  reset (void);
+
+  static int
+  bucket (uint32_t ms);
+
+private:
+
+  entry_t* touch (int index);
+
+  entry_t entries_[entries] = { };
+  uint64_t active_ = 0;         // one bit per updated entry
+
+  os::rtos::mutex mutex_
+    { "sdi12_st" };
+
+};
+
+/**
+ * @brief Return the histogram bucket of a latency.
+ * @param ms: latency in ms.
+ */
+inline int
+sdi12_stats::bucket (uint32_t ms)
+{
+  int b = 0;
+
+  while (ms != 0 && b < buckets - 1)
+    {
+      ms >>= 1;
+      b++;
+    }
+  return b;
+}
+
+/**
+ * @brief Lock the table and return an entry, marked as updated.
+ */
+inline sdi12_stats::entry_t*
+sdi12_stats::touch (int index)
+{
+  mutex_.lock ();
+  active_ |= 1ULL << index;
+  return &entries_[index];
+}
+
+/**
+ * @brief Increment a counter of a sensor.
+ * @param index: index of the sensor's address.
+ * @param counter: the counter.
+ */
+inline void
+sdi12_stats::add (int index, counter_t counter)
+{
+  if (index >= 0 && index < entries)
+    {
+      touch (index)->count[counter]++;
+      mutex_.unlock ();
+    }
+}
+
+/**
+ * @brief Account for a service request.
+ * @param index: index of the sensor's address.
+ * @param announced_ms: measurement time announced by the sensor.
+ * @param actual_ms: time until the service request was received.
+ */
+inline void
+sdi12_stats::response (int index, uint32_t announced_ms, uint32_t actual_ms)
+{
+  if (index >= 0 && index < entries)
+    {
+      entry_t* e = touch (index);
+      e->responses++;
+      e->announced_ms += announced_ms;
+      e->actual_ms += actual_ms;
+      mutex_.unlock ();
+    }
+}
+
+/**
+ * @brief Account for the latency of an answer.
+ */
+inline void
+sdi12_stats::answer (int index, uint32_t ms)
+{
+  if (index >= 0 && index < entries)
+    {
+      touch (index)->answer[bucket (ms)]++;
+      mutex_.unlock ();
+    }
+}
+
+/**
+ * @brief Account for the time between the end of a measurement and the
+ *      reception of its data.
+ */
+inline void
+sdi12_stats::collect (int index, uint32_t ms)
+{
+  if (index >= 0 && index < entries)
+    {
+      touch (index)->collect[bucket (ms)]++;
+      mutex_.unlock ();
+    }
+}
+
+/**
+ * @brief Account for commands not sent to a sensor that does not answer
+ *      (see sdi12_retry_policy).
+ * @param index: index of the sensor's address.
+ * @param commands: number of commands not sent.
+ * @param ms: bus time they would have taken.
+ */
+inline void
+sdi12_stats::saved (int index, uint32_t commands, uint32_t ms)
+{
+  if (index >= 0 && index < entries)
+    {
+      entry_t* e = touch (index);
+      e->count[skipped] += commands;
+      e->saved_ms += ms;
+      mutex_.unlock ();
+    }
+}
+
+/**
+ * @brief Return a bitmap of the entries updated since they were cleared,
+ *      one bit per address index.
+ */
+inline uint64_t
+sdi12_stats::active (void)
+{
+  mutex_.lock ();
+  uint64_t active = active_;
+  mutex_.unlock ();
+
+  return active;
+}
+
+/**
+ * @brief Copy the entry of a sensor.
+ * @param index: index of the sensor's address.
+ * @param entry: returns a consistent copy of the entry.
+ * @param clear: if true, the entry is cleared after the copy.
+ * @return true if successful, false if the index is not valid.
+ */
+inline bool
+sdi12_stats::snapshot (int index, entry_t& entry, bool clear)
+{
+  if (index < 0 || index >= entries)
+    {
+      return false;
+    }
+
+  mutex_.lock ();
+  entry = entries_[index];
+  if (clear)
+    {
+      memset (&entries_[index], 0, sizeof(entry_t));
+      active_ &= ~(1ULL << index);
+    }
+  mutex_.unlock ();
+
+  return true;
+}
+
+/**
+ * @brief Clear all the entries.
+ */
+inline void
+sdi12_stats::reset (void)
+{
+  mutex_.lock ();
+  memset (entries_, 0, sizeof(entries_));
+  active_ = 0;
+  mutex_.unlock ();
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* SDI_12_STATS_H_ */
@@ -0,0 +1,250 @@
+/*
+ * sdi-12-trace.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+/*
+ * This file implements the binary recorder of the bus events. It does not
+ * depend on the RTOS, so that the decoder can be built on a host as well.
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "sdi-12-trace.h"
+
+/**
+ * @brief Record an event.
+ * @param time: time of the event, in µs.
+ * @param type: type of the event.
+ * @param addr: address of the sensor.
+ * @param data: bytes sent or received, or nullptr.
+ * @param length: number of bytes, up to 255.
+ * @param aux: additional information, depending on the type.
+ */
+void
+sdi12_trace::record (uint64_t time, type_t type, char addr, const void* data,
+                     size_t length, uint8_t aux)
+{
+  uint8_t header[header_size];
+  uint32_t high = time >> 32;
+
+  if (high != high_)
+    {
+      // the time wrapped (or first event): record the high part first
+      header[0] = high;
+      header[1] = high >> 8;
+      header[2] = high >> 16;
+      header[3] = high >> 24;
+      header[4] = time_high;
+      header[5] = header[6] = header[7] = 0;
+      if (put (header, nullptr, 0) == false)
+        {
+          return;
+        }
+      high_ = high;
+    }
+
+  length = length > 255 ? 255 : length;
+  header[0] = time;
+  header[1] = time >> 8;
+  header[2] = time >> 16;
+  header[3] = time >> 24;
+  header[4] = type;
+  header[5] = addr;
+  header[6] = length;
+  header[7] = aux;
+  put (header, data, length);
+}
+
+/**
+ * @brief Copy an event to the ring, if there is room for all of it.
+ */
+bool
+sdi12_trace::put (const uint8_t* header, const void* data, size_t length)
+{
+  uint32_t tail = tail_.load (std::memory_order_relaxed);
+  size_t size = header_size + length;
+
+  if (capacity - (tail - head_.load (std::memory_order_acquire)) < size)
+    {
+      dropped_.fetch_add (1, std::memory_order_relaxed);
+      return false;
+    }
+
+  for (size_t i = 0; i < header_size; i++)
+    {
+      ring_[(tail++) & (capacity - 1)] = header[i];
+    }
+  for (size_t i = 0; i < length; i++)
+    {
+      ring_[(tail++) & (capacity - 1)] =
+          static_cast<const uint8_t*> (data)[i];
+    }
+  tail_.store (tail, std::memory_order_release);
+
+  return true;
+}
+
+/**
+ * @brief Read raw events from the ring; only whole events are copied.
+ * @param buff: buffer for the events.
+ * @param len: length of the buffer, at least header_size + 255 bytes to
+ *      be sure that any event fits.
+ * @return the number of bytes copied.
+ */
+size_t
+sdi12_trace::read (uint8_t* buff, size_t len)
+{
+  uint32_t head = head_.load (std::memory_order_relaxed);
+  uint32_t tail = tail_.load (std::memory_order_acquire);
+  size_t count = 0;
+
+  while (tail - (head + count) >= header_size)
+    {
+      size_t size = header_size
+          + ring_[(head + count + 6) & (capacity - 1)];
+      if (count + size > len)
+        {
+          break;
+        }
+      for (size_t i = 0; i < size; i++)
+        {
+          buff[count + i] = ring_[(head + count + i) & (capacity - 1)];
+        }
+      count += size;
+    }
+  head_.store (head + count, std::memory_order_release);
+
+  return count;
+}
+
+/**
+ * @brief Decode an event read from the ring.
+ * @param buff: raw events.
+ * @param len: number of bytes in the buffer.
+ * @param high: high part of the time, updated by the time_high events;
+ *      keep it from one call to the next.
+ * @param event: returns the event; its data points into the buffer.
+ * @return the number of bytes of the event, or 0 if the buffer does not
+ *      contain a whole event.
+ */
+size_t
+sdi12_trace::decode (const uint8_t* buff, size_t len, uint32_t& high,
+                     event_t& event)
+{
+  if (len < header_size || len < header_size + buff[6])
+    {
+      return 0;
+    }
+
+  uint32_t low = buff[0] | (buff[1] << 8) | (buff[2] << 16)
+      | ((uint32_t) buff[3] << 24);
+  event.type = static_cast<type_t> (buff[4]);
+  if (event.type == time_high)
+    {
+      high = low;
+    }
+  event.time = ((uint64_t) high << 32) | low;
+  event.addr = buff[5];
+  event.length = buff[6];
+  event.aux = buff[7];
+  event.data = buff + header_size;
+
+  return header_size + event.length;
+}
+
+/**
+ * @brief Format an event as a line of text, like the transaction dumps of
+ *      the previous versions: start and end time in ms relative to a base
+ *      time, direction and bytes (the CR/LF is not printed).
+ * @param event: the event.
+ * @param base: time the times are relative to, in µs.
+ * @param text: buffer for the text.
+ * @param len: length of the buffer.
+ * @return the length of the text, 0 for the events that are not printed
+ *      (time_high).
+ */
+size_t
+sdi12_trace::format (const event_t& event, uint64_t base, char* text,
+                     size_t len)
+{
+  constexpr uint32_t char_us = 8333;    // 10 bits at 1200 baud
+  uint32_t t = (event.time - base) / 1000;
+  uint32_t span = (event.length * char_us) / 1000;
+  int n = 0;
+  int bytes = event.length;
+
+  while (bytes > 0
+      && (event.data[bytes - 1] == '\r' || event.data[bytes - 1] == '\n'))
+    {
+      bytes--;
+    }
+
+  switch (event.type)
+    {
+    case command:
+      n = snprintf (text, len, "%05" PRIu32 "-%05" PRIu32 " --> %.*s", t,
+                    t + span, bytes, event.data);
+      break;
+    case answer:
+      n = snprintf (text, len, "%05" PRIu32 "-%05" PRIu32 " <-- %.*s",
+                    t > span ? t - span : 0, t, bytes, event.data);
+      break;
+    case brk:
+      n = snprintf (text, len, "%05" PRIu32 "-%05" PRIu32 " --> break", t,
+                    t + event.aux);
+      break;
+    case timeout:
+      n = snprintf (text, len, "~~~~~-%05" PRIu32 " <-- %c timeout", t,
+                    event.addr);
+      break;
+    case write_failed:
+      n = snprintf (text, len, "%05" PRIu32 "-~~~~~ --> write failed", t);
+      break;
+    case invalid_value:
+      n = snprintf (text, len, "~~~~~-%05" PRIu32 " <-- invalid value at %d",
+                    t, event.aux);
+      break;
+    case packet:
+      if (event.length >= 4)
+        {
+          // address, payload size, type, payload and two bytes of CRC
+          unsigned size = event.data[1] | (event.data[2] << 8);
+          span = ((6 + size) * char_us) / 1000;
+          n = snprintf (text, len,
+                        "%05" PRIu32 "-%05" PRIu32 " <-- %c<%u bytes, type %u>",
+                        t > span ? t - span : 0, t, event.data[0], size,
+                        event.data[3]);
+        }
+      break;
+    default:
+      break;
+    }
+
+  return n > 0 ? ((size_t) n < len ? n : len - 1) : 0;
+}
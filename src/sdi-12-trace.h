@@ -0,0 +1,150 @@
+/*
+ * sdi-12-trace.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef SDI_12_TRACE_H_
+#define SDI_12_TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+#ifndef SDI_TRACE_SIZE
+#define SDI_TRACE_SIZE 512      // bytes, a power of 2
+#endif
+
+#if defined (__cplusplus)
+
+/*
+ * Binary recorder of the bus events (breaks, commands, answers, errors).
+ * Each event is stored as an 8 bytes header (time in µs, type, address,
+ * length, auxiliary byte) followed by the raw bytes sent or received, in a
+ * lock-free ring with one producer, the thread holding the bus, and one
+ * consumer; recording an event only copies a few bytes, so the bus timing
+ * is not disturbed. The events are formatted off the hot path: the
+ * consumer reads the raw events with read() and either decodes and formats
+ * them with decode() and format(), or stores or forwards them as they are,
+ * to be decoded offline (see tools/sdi12-trace-decode.cpp). Events that do
+ * not fit in the ring are dropped and counted.
+ */
+class sdi12_trace
+{
+public:
+
+  typedef enum : uint8_t
+  {
+    command = 1,        // bytes sent
+    answer,             // bytes received, the time is the end of the frame
+    brk,                // break sent
+    timeout,            // no answer
+    write_failed,       // the command could not be sent
+    invalid_value,      // answer with a malformed value, aux is the position
+    time_high,          // high 32 bits of the time of the next events
+    packet              // binary packet received, only its header is kept
+  } type_t;
+
+  typedef struct event_
+  {
+    uint64_t time;      // in µs
+    type_t type;
+    char addr;
+    uint8_t aux;
+    uint8_t length;
+    const uint8_t* data;        // the bytes, in the decoded buffer
+  } event_t;
+
+  static constexpr size_t header_size = 8;
+  static constexpr size_t capacity = SDI_TRACE_SIZE;
+
+  static_assert((capacity & (capacity - 1)) == 0,
+      "SDI_TRACE_SIZE must be a power of 2");
+
+  // producer
+
+  void
+  record (uint64_t time, type_t type, char addr, const void* data = nullptr,
+          size_t length = 0, uint8_t aux = 0);
+
+  // consumer
+
+  size_t
+  available (void);
+
+  size_t
+  read (uint8_t* buff, size_t len);
+
+  uint32_t
+  dropped (void);
+
+  // decoding, on the target or on a host
+
+  static size_t
+  decode (const uint8_t* buff, size_t len, uint32_t& high, event_t& event);
+
+  static size_t
+  format (const event_t& event, uint64_t base, char* text, size_t len);
+
+private:
+
+  bool
+  put (const uint8_t* header, const void* data, size_t length);
+
+  uint8_t ring_[SDI_TRACE_SIZE];
+  std::atomic<uint32_t> head_
+    { 0 };              // next byte to be read, written by the consumer
+  std::atomic<uint32_t> tail_
+    { 0 };              // next byte to be written, written by the producer
+  std::atomic<uint32_t> dropped_
+    { 0 };
+  uint32_t high_ = 0xFFFFFFFF;  // high part of the time of the last event
+
+};
+
+/**
+ * @brief Return the number of bytes ready to be read.
+ */
+inline size_t
+sdi12_trace::available (void)
+{
+  return tail_.load (std::memory_order_acquire)
+      - head_.load (std::memory_order_relaxed);
+}
+
+/**
+ * @brief Return the number of events lost because the ring was full.
+ */
+inline uint32_t
+sdi12_trace::dropped (void)
+{
+  return dropped_.load (std::memory_order_relaxed);
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* SDI_12_TRACE_H_ */
@@ -0,0 +1,1590 @@
+/*
+ * bench-sdi12dr.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+/*
+ * Benchmarks for the SDI-12 data recorder. All results are printed as
+ * comma separated values, one line per measurement, with a header line
+ * starting with '#'.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include "bench-sdi12dr.h"
+#include "sdi-12-dr.h"
+#include "sdi-12-parser.h"
+#include "sdi-12-sim.h"
+#include "sdi-12-heap.h"
+#include "sdi-12-trace.h"
+#include "sdi-12-manager.h"
+#include "dacq-clock.h"
+#include "sysconfig.h"
+
+#if SDI12_BENCH == true
+
+using namespace os;
+using namespace os::rtos;
+
+// one character at 1200 baud, in microseconds
+static constexpr int char_time_us = 8333;
+
+// a recorded byte stream and its length (it may contain nulls)
+#define RECORDED(s) s, sizeof(s) - 1
+
+// receive timeout as set by dacq::open() in the test (50 ms)
+static constexpr int vtime_us = 50000;
+
+/*
+ * Model of a tty driver answering read() requests from a recorded byte
+ * stream. Byte i of the stream is fully received (i + 1) character times
+ * after the start, plus an optional pause inserted before byte 'gap_at'.
+ */
+class model_tty
+{
+public:
+
+  typedef enum
+  {
+    count_or_vtime, // returns when count is satisfied or VTIME idle
+    idle_line,      // returns at the end of each burst of characters
+  } driver_t;
+
+  model_tty (const char* stream, size_t len, driver_t drv, size_t gap_at,
+             int gap_us);
+
+  int
+  read (char* buff, size_t count);
+
+  int now_us = 0;
+
+private:
+
+  int
+  arrival (size_t i);
+
+  const char* stream_;
+  size_t len_;
+  driver_t drv_;
+  size_t gap_at_;
+  int gap_us_;
+  size_t pos_ = 0;
+};
+
+model_tty::model_tty (const char* stream, size_t len, driver_t drv,
+                      size_t gap_at, int gap_us) :
+    stream_ (stream), len_ (len), drv_ (drv), gap_at_ (gap_at), gap_us_ (
+        gap_us)
+{
+}
+
+int
+model_tty::arrival (size_t i)
+{
+  return (i + 1) * char_time_us + (i >= gap_at_ ? gap_us_ : 0);
+}
+
+int
+model_tty::read (char* buff, size_t count)
+{
+  int deadline = now_us + vtime_us;
+  size_t got = 0;
+
+  while (got < count && pos_ < len_ && arrival (pos_) <= deadline)
+    {
+      int t = arrival (pos_);
+      now_us = std::max (now_us, t);
+      buff[got++] = stream_[pos_++];
+      deadline = now_us + (drv_ == idle_line ? char_time_us : vtime_us);
+    }
+
+  if (got < count)
+    {
+      now_us = deadline;        // the driver waited for more characters
+    }
+
+  return got;
+}
+
+/*
+ * The receive loop as implemented by transaction() up to version 1.5.4.
+ */
+static int
+legacy_read (model_tty& tty, char* answer, size_t size)
+{
+  size_t offset = 0;
+  int result;
+
+  do
+    {
+      result = tty.read (answer + offset, size - offset);
+      if (result <= 0)
+        {
+          break;
+        }
+      offset += result;
+      if (answer[offset - 1] == '\n' && answer[offset - 2] == '\r')
+        {
+          return offset;
+        }
+    }
+  while (offset < size);
+
+  return -1;
+}
+
+/*
+ * The receive loop based on the incremental frame assembler.
+ */
+static int
+assembler_read (model_tty& tty, sdi12_frame& frame)
+{
+  int result;
+
+  frame.reset ();
+  do
+    {
+      result = tty.read (frame.tail (), frame.wanted ());
+      if (result <= 0)
+        {
+          break;
+        }
+    }
+  while (frame.commit (result) == false && frame.full () == false);
+
+  return frame.complete () ? (int) frame.length () : -1;
+}
+
+/**
+ * @brief Compare the latency between the arrival of the LF and the moment
+ *      the receive loop returns a complete frame, for a few recorded frames
+ *      and two tty driver behaviours. A failed read shows a negative latency
+ *      (it would cause a retry in transaction()).
+ */
+static void
+bench_frame (void)
+{
+  static const struct
+  {
+    const char* name;
+    const char* bytes;
+    size_t len;
+    size_t gap_at;
+    int gap_us;
+  } frames[] =
+    {
+      { "short", RECORDED ("0+3.14+2.718\r\n"), 99, 0 },
+      { "trailing_nul", RECORDED ("0+3.14+2.718\r\n\0"), 99, 0 },
+      { "pause", RECORDED ("0+22.5-1.25+1013.2\r\n"), 6, 30000 },
+      { "long", RECORDED ("0+1.234567+2.345678+3.456789+4.567891+5.678912"
+          "+6.789123+7.891234+8.912345\r\n"), 99, 0 },
+      { "two_frames", RECORDED ("0+1.5\r\n0+2.5\r\n"), 99, 0 }, };
+
+  static const char* drivers[] =
+    { "count_or_vtime", "idle_line" };
+
+  trace::printf ("# frame,driver,lf_us,legacy_us,assembler_us\n");
+
+  for (auto& f : frames)
+    {
+      // the LF of the first frame in the stream
+      size_t lf = strchr (f.bytes, '\n') - f.bytes;
+
+      for (int d = 0; d < 2; d++)
+        {
+          model_tty::driver_t drv = static_cast<model_tty::driver_t> (d);
+          char answer[sdi12_frame::max_length];
+          sdi12_frame frame;
+
+          model_tty t1
+            { f.bytes, f.len, drv, f.gap_at, f.gap_us };
+          model_tty t2
+            { f.bytes, f.len, drv, f.gap_at, f.gap_us };
+
+          int lf_us = (lf + 1) * char_time_us + (lf >= f.gap_at ? f.gap_us : 0);
+          int legacy = legacy_read (t1, answer, sizeof(answer));
+          int assembler = assembler_read (t2, frame);
+
+          trace::printf ("%s,%s,%d,%d,%d\n", f.name, drivers[d], lf_us,
+                         legacy > 0 ? t1.now_us - lf_us : -1,
+                         assembler > 0 ? t2.now_us - lf_us : -1);
+        }
+    }
+}
+
+/*
+ * The CRC computation as implemented by sdi12_dr::calc_crc() up to
+ * version 1.5.4.
+ */
+static uint16_t
+legacy_crc (uint16_t initial, uint8_t* buff, uint16_t buff_len)
+{
+  for (uint16_t count = 0; count < buff_len; count++)
+    {
+      initial ^= *buff++;
+      int cnt_byte = 8;
+      while (cnt_byte-- > 0)
+        {
+          if (initial & 1)
+            {
+              initial >>= 1;
+              initial ^= 0xA001;
+            }
+          else
+            initial >>= 1;
+        }
+    }
+
+  return initial;
+}
+
+/**
+ * @brief Compare the CRC engines on a typical CRC protected D frame. The
+ *      "frame" variant feeds the frame assembler one byte at a time, as
+ *      transaction() does, and includes the CR/LF scanning.
+ */
+static void
+bench_crc (void)
+{
+  constexpr int iterations = 20000;
+  char frame[] = "0+3.14+2.718+1013.25-0.5+17.3+99.99+0.001CCC\r\n";
+  size_t len = strlen (frame);
+  size_t payload = len - 5;
+  volatile uint16_t sink = 0;
+
+  sdi12_crc::to_ascii (legacy_crc (0, (uint8_t*) frame, payload),
+                       frame + payload);
+
+  trace::printf ("# variant,bytes,ms,ns_per_byte,crc_ok\n");
+
+  for (int v = 0; v < 5; v++)
+    {
+      static const char* names[] =
+        { "legacy", "bitwise", "nibble", "table", "frame" };
+      sdi12_frame assembler;
+      bool ok = true;
+
+      clock::timestamp_t start = sysclock.now ();
+      for (int i = 0; i < iterations; i++)
+        {
+          uint16_t crc = 0;
+          switch (v)
+            {
+            case 0:
+              crc = legacy_crc (0, (uint8_t*) frame, payload);
+              break;
+            case 1:
+              for (size_t j = 0; j < payload; j++)
+                crc = sdi12_crc::update_bitwise (crc, frame[j]);
+              break;
+            case 2:
+              for (size_t j = 0; j < payload; j++)
+                crc = sdi12_crc::update_nibble (crc, frame[j]);
+              break;
+            case 3:
+              for (size_t j = 0; j < payload; j++)
+                crc = sdi12_crc::update_table (crc, frame[j]);
+              break;
+            case 4:
+              assembler.reset ();
+              for (size_t j = 0; j < len; j++)
+                {
+                  *assembler.tail () = frame[j];
+                  assembler.commit (1);
+                }
+              if (assembler.crc_valid ())
+                {
+                  crc = sdi12_crc::from_ascii (frame + payload);
+                }
+              break;
+            }
+          ok &= (crc == sdi12_crc::from_ascii (frame + payload));
+          sink = sink + crc;
+        }
+      uint32_t ms = sysclock.now () - start;
+      uint32_t bytes = payload * iterations;
+
+      trace::printf ("%s,%u,%u,%u,%d\n", names[v], bytes, ms,
+                     (uint32_t) ((uint64_t) ms * 1000000 / bytes), ok);
+    }
+}
+
+/*
+ * The value conversion as implemented by sdi12_dr::get_data() up to
+ * version 1.5.4; 'values' must be null terminated.
+ */
+static int
+legacy_values (char* values, float* data, int max)
+{
+  char* p, * r = values;
+  int parsed = 0;
+
+  do
+    {
+      p = r;
+      data[parsed] = strtof (p, &r);
+      if (data[parsed] == 0 && p == r)
+        {
+          return -1;
+        }
+      parsed++;
+    }
+  while (*r != '\0' && parsed < max);
+
+  return parsed;
+}
+
+/**
+ * @brief Compare strtof() with the SDI-12 tokenizer on recorded D frames
+ *      (values only, without address and CR/LF). The "scaled" variant
+ *      stops at the integer mantissa and exponent.
+ */
+static void
+bench_parser (void)
+{
+  constexpr int iterations = 20000;
+  static const char* frames[] =
+    {
+      "+3.14+2.718-1.5",
+      "+22.51-0.003+1013.2+0+0.0+99",
+      "+1.234567+2.345678+3.456789+4.567891+5.678912+6.789123+7.891234",
+      "-.0000001+9999999+.5-12." };
+  volatile float sink = 0;
+
+  trace::printf ("# frame,variant,values,ms,ns_per_value,match\n");
+
+  for (size_t f = 0; f < sizeof(frames) / sizeof(frames[0]); f++)
+    {
+      char buff[sdi12_frame::max_length];
+      float reference[20];
+      float data[20];
+      size_t len = strlen (frames[f]);
+      int count = 0;
+
+      strcpy (buff, frames[f]);
+      int expected = legacy_values (buff, reference, 20);
+
+      for (int v = 0; v < 3; v++)
+        {
+          static const char* names[] =
+            { "strtof", "float", "scaled" };
+          bool match = true;
+
+          clock::timestamp_t start = sysclock.now ();
+          for (int i = 0; i < iterations; i++)
+            {
+              if (v == 0)
+                {
+                  count = legacy_values (buff, data, 20);
+                }
+              else
+                {
+                  sdi12_parser parser
+                    { buff, buff + len };
+                  int32_t mantissa;
+                  int8_t exponent;
+                  count = 0;
+                  while (parser.next (mantissa, exponent)
+                      == sdi12_parser::value)
+                    {
+                      if (v == 1)
+                        {
+                          data[count++] = sdi12_parser::to_float (mantissa,
+                                                                  exponent);
+                        }
+                      else
+                        {
+                          data[count++] = mantissa;
+                        }
+                    }
+                }
+              sink = sink + data[0];
+            }
+          uint32_t ms = sysclock.now () - start;
+
+          if (v < 2)
+            {
+              match = (count == expected)
+                  && memcmp (data, reference, count * sizeof(float)) == 0;
+            }
+          trace::printf ("%u,%s,%d,%u,%u,%d\n", f, names[v], count, ms,
+                         count ? (uint32_t) ((uint64_t) ms * 1000000
+                             / (iterations * count)) : 0, match);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+
+typedef struct deadline_entry_
+{
+  clock::timestamp_t deadline;
+  uint16_t heap_index;
+} deadline_entry_t;
+
+/**
+ * @brief Scheduling benchmark: the cost of finding the pending request with
+ *      the nearest deadline and replacing it with a new request, as done by
+ *      the collect thread, for several numbers of pending requests: the
+ *      linear scan of the request table used up to version 1.5.4, compared
+ *      with the deadline heap.
+ */
+static void
+bench_deadline (void)
+{
+  constexpr int iterations = 100000;
+  constexpr int max_entries = 1024;
+  static const int sizes[] =
+    { 10, 62, 256, max_entries };
+  static deadline_entry_t entries[max_entries];
+  static deadline_entry_t* items[max_entries];
+  volatile uint32_t sink = 0;
+
+  trace::printf ("# pending,variant,ns_per_request\n");
+
+  for (int n : sizes)
+    {
+      for (int v = 0; v < 2; v++)
+        {
+          static const char* names[] =
+            { "linear", "heap" };
+          sdi12_heap<deadline_entry_t> heap
+            { items, max_entries };
+          uint32_t seed = 1;
+
+          for (int i = 0; i < n; i++)
+            {
+              seed = seed * 1103515245 + 12345;
+              entries[i].deadline = (seed >> 16) % 10000;
+              if (v == 1)
+                {
+                  heap.push (&entries[i]);
+                }
+            }
+
+          clock::timestamp_t start = sysclock.now ();
+          for (int i = 0; i < iterations; i++)
+            {
+              deadline_entry_t* next = nullptr;
+              if (v == 0)
+                {
+                  clock::timestamp_t nearest = ~0ULL;
+                  for (int k = 0; k < n; k++)
+                    {
+                      if (entries[k].deadline < nearest)
+                        {
+                          nearest = entries[k].deadline;
+                          next = &entries[k];
+                        }
+                    }
+                }
+              else
+                {
+                  next = heap.pop ();
+                }
+
+              // the request is done, a new one takes its place
+              seed = seed * 1103515245 + 12345;
+              next->deadline += 1 + (seed >> 16) % 10000;
+              sink = sink + next->deadline;
+              if (v == 1)
+                {
+                  heap.push (next);
+                }
+            }
+          uint32_t ms = sysclock.now () - start;
+
+          trace::printf ("%d,%s,%u\n", n, names[v],
+                         (uint32_t) ((uint64_t) ms * 1000000 / iterations));
+        }
+    }
+}
+
+static char legacy_dump_buffer[128];
+static volatile uint32_t dump_sink;
+
+static void
+dump_fn (char* line)
+{
+  dump_sink = dump_sink + line[0];
+}
+
+/*
+ * The transaction dump of sdi12_dr up to version 1.5.4, called for each
+ * event with the bus locked.
+ */
+static void
+legacy_dump (const char* fmt, ...)
+{
+  va_list ap;
+
+  memset (legacy_dump_buffer, 0, sizeof(legacy_dump_buffer));
+  va_start(ap, fmt);
+  vsnprintf (legacy_dump_buffer, sizeof(legacy_dump_buffer), fmt, ap);
+  va_end(ap);
+
+  dump_fn (legacy_dump_buffer);
+}
+
+/**
+ * @brief Trace benchmark: the cost per event of tracing a command and its
+ *      answer: formatted with vsnprintf() on the hot path, as in version
+ *      1.5.4 ("vsnprintf"); recorded in binary form and read by the
+ *      consumer, e.g. to be stored ("record"); recorded, read, decoded and
+ *      formatted by the consumer ("format").
+ */
+static void
+bench_trace (void)
+{
+  constexpr int iterations = 200000;
+  static const char command[] = "0D0!";
+  static const char answer[] = "0+3.14+2.718+1013.25-0.5+17.3\r\n";
+  static sdi12_trace recorder;
+  static uint8_t raw[sdi12_trace::capacity];
+  static char text[128];
+  uint32_t us[3] =
+    { 0, 0, 0 };
+  uint32_t high = 0;
+
+  trace::printf ("# variant,events,ns_per_event,dropped\n");
+
+  clock::timestamp_t start = sysclock.now ();
+  for (int i = 0; i < iterations; i++)
+    {
+      legacy_dump ("%05d-%05d --> %.*s", i, i + 33, 4, command);
+      legacy_dump ("%05d-%05d <-- %.*s", i + 40, i + 300,
+                   (int) sizeof(answer) - 1, answer);
+    }
+  us[0] = (sysclock.now () - start) * 1000;
+
+  for (int v = 1; v < 3; v++)
+    {
+      start = sysclock.now ();
+      for (int i = 0; i < iterations; i++)
+        {
+          recorder.record (i * 1000, sdi12_trace::command, command[0],
+                           command, 4);
+          recorder.record (i * 1000 + 300, sdi12_trace::answer, answer[0],
+                           answer, sizeof(answer) - 1);
+          if ((i & 3) != 3)
+            {
+              continue;
+            }
+          // drained every 4 transactions, as a consumer would
+          size_t count = recorder.read (raw, sizeof(raw));
+          size_t pos = 0;
+          size_t n;
+          sdi12_trace::event_t event;
+          while (v == 2
+              && (n = sdi12_trace::decode (raw + pos, count - pos, high, event))
+                  > 0)
+            {
+              pos += n;
+              if (sdi12_trace::format (event, 0, text, sizeof(text)) > 0)
+                {
+                  dump_fn (text);
+                }
+            }
+        }
+      us[v] = (sysclock.now () - start) * 1000;
+    }
+
+  static const char* names[] =
+    { "vsnprintf", "record", "format" };
+  for (int v = 0; v < 3; v++)
+    {
+      trace::printf ("%s,%u,%u,%u\n", names[v], 2 * iterations,
+                     (uint32_t) ((uint64_t) us[v] * 1000 / (2 * iterations)),
+                     v ? recorder.dropped () : 0);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+// the sweeps run on a simulated bus with a virtual clock
+static dacq_virtual_clock sweep_clock;
+static sdi12_sim sweep_bus;
+static sdi12_dr sweep_dr
+  { sweep_bus };
+
+static constexpr int sweep_max_values = 20;
+static constexpr int sweep_rounds = 2;
+
+typedef struct sweep_sensor_
+{
+  dacq::dacq_handle_t dh;
+  sdi12_dr::sdi12_t sdi;
+  float data[sweep_max_values];
+  uint8_t status[sweep_max_values];
+  clock::timestamp_t start;     // time the retrieval was requested
+  uint32_t latency;             // time until the data was delivered, in ms
+  bool pending;                 // a concurrent retrieval was started
+} sweep_sensor_t;
+
+static sweep_sensor_t sweep_sensors[sdi12_dr::max_addresses];
+static uint32_t sweep_latency[sdi12_dr::max_addresses * sweep_rounds];
+
+static semaphore_counting sweep_sem
+  { "sweep", sdi12_dr::max_addresses, 0 };
+
+/*
+ * Call-back of the concurrent retrievals, called by the collect thread.
+ */
+static bool
+sweep_cb (void* param)
+{
+  dacq::dacq_handle_t* dh = static_cast<dacq::dacq_handle_t*> (param);
+  sweep_sensor_t* s = static_cast<sweep_sensor_t*> (dh->cb_parameter);
+
+  s->latency = sweep_clock.now () - s->start;
+  sweep_sem.post ();
+  return true;
+}
+
+static int
+sweep_compare (const void* a, const void* b)
+{
+  uint32_t x = *static_cast<const uint32_t*> (a);
+  uint32_t y = *static_cast<const uint32_t*> (b);
+
+  return x < y ? -1 : x > y;
+}
+
+/**
+ * @brief Prepare a retrieval request for a sensor.
+ */
+static void
+sweep_request (sweep_sensor_t* s, char addr, char method, bool crc)
+{
+  s->dh.data = s->data;
+  s->dh.status = s->status;
+  s->dh.data_count = sweep_max_values;
+  s->dh.impl = &s->sdi;
+  s->dh.cb = method == sdi12_dr::concurrent ? sweep_cb : nullptr;
+  s->dh.cb_parameter = s;
+  s->sdi.addr = addr;
+  s->sdi.method = static_cast<sdi12_dr::method_t> (method);
+  s->sdi.index = 0;
+  s->sdi.use_crc = crc;
+  s->sdi.max_waiting = 0;
+  s->sdi.strict_break = false;
+  s->sdi.fixed = nullptr;
+  s->start = sweep_clock.now ();
+  s->pending = false;
+}
+
+/**
+ * @brief Sweep the whole bus, i.e. retrieve the data of each sensor.
+ * @return the number of failed retrievals.
+ */
+static int
+sweep (int sensors, char method, bool crc, uint16_t ttt, int& samples)
+{
+  int errors = 0;
+
+  for (int i = 0; i < sensors; i++)
+    {
+      sweep_sensor_t* s = &sweep_sensors[i];
+      sweep_request (s, sdi12_dr::index_to_addr (i), method, crc);
+      if (method != sdi12_dr::concurrent)
+        {
+          if (sweep_dr.retrieve (&s->dh))
+            {
+              sweep_latency[samples++] = sweep_clock.now () - s->start;
+            }
+          else
+            {
+              errors++;
+            }
+          continue;
+        }
+      // concurrent: wait for a free slot if the table is full, or for the
+      // bus if the collect thread is busy
+      s->pending = true;
+      while (sweep_dr.retrieve (&s->dh) == false)
+        {
+          if (sweep_dr.error->error_number != dacq::too_many_requests
+              && sweep_dr.error->error_number != dacq::dacq_busy)
+            {
+              s->pending = false;
+              errors++;
+              break;
+            }
+          sweep_clock.sleep_for (100);
+        }
+    }
+
+  if (method == sdi12_dr::concurrent)
+    {
+      for (int i = errors; i < sensors; i++)
+        {
+          if (sweep_clock.timed_wait (sweep_sem, ttt * 1000 + 10000) != 0)
+            {
+              errors += sensors - i;
+              break;
+            }
+        }
+      for (int i = 0; i < sensors; i++)
+        {
+          if (sweep_sensors[i].pending)
+            {
+              sweep_latency[samples++] = sweep_sensors[i].latency;
+            }
+        }
+    }
+
+  return errors;
+}
+
+/**
+ * @brief Configure the simulated bus, sweep it and print the results.
+ * @param slots: maximum number of concurrent requests (C only).
+ */
+static void
+sweep_scenario (char m, int n, uint8_t v, bool crc, uint16_t ttt,
+                size_t slots)
+{
+  for (int i = 0; i < sdi12_dr::max_addresses; i++)
+    {
+      char addr = sdi12_dr::index_to_addr (i);
+      if (i < n)
+        {
+          sdi12_sim::sensor_t* s = sweep_bus.add (addr);
+          s->values = v;
+          s->ttt = ttt;
+          s->ready = ttt * 750;
+        }
+      else
+        {
+          sweep_bus.remove (addr);
+        }
+    }
+#if MAX_CONCURRENT_REQUESTS > 0
+  if (m == sdi12_dr::concurrent && sweep_dr.set_max_concurrent (slots) == false)
+    {
+      trace::printf ("# sweep: %s\n", sweep_dr.error->error_text);
+      return;
+    }
+#endif
+  sweep_bus.reset_stats ();
+
+  int samples = 0;
+  int errors = 0;
+  clock::timestamp_t start = sweep_clock.now ();
+  for (int r = 0; r < sweep_rounds; r++)
+    {
+      errors += sweep (n, m, crc, ttt, samples);
+    }
+  uint64_t total = sweep_clock.now () - start;
+
+  qsort (sweep_latency, samples, sizeof(uint32_t), sweep_compare);
+  const sdi12_sim::stats_t& st = sweep_bus.stats ();
+  uint32_t busy = total ? st.busy / total : 0;          // 0.1%
+  uint32_t brk = total ? st.break_time / total : 0;     // 0.1%
+  uint32_t p[4] =
+    { 0, 0, 0, 0 };
+  if (samples)
+    {
+      p[0] = sweep_latency[(samples - 1) * 50 / 100];
+      p[1] = sweep_latency[(samples - 1) * 90 / 100];
+      p[2] = sweep_latency[(samples - 1) * 99 / 100];
+      p[3] = sweep_latency[samples - 1];
+    }
+
+  trace::printf ("%c,%d,%u,%d,%u,%u,%u,%u.%u,%u,%u.%u,%u,%u,%u,%u,%d\n", m, n,
+                 v, crc, ttt, m == sdi12_dr::concurrent ? slots : 0,
+                 (uint32_t) (total / sweep_rounds), busy / 10, busy % 10,
+                 st.breaks / sweep_rounds, brk / 10, brk % 10, p[0], p[1],
+                 p[2], p[3], errors);
+}
+
+/**
+ * @brief Sweep benchmark: retrieve the data of all sensors on a simulated
+ *      bus, with the M, C and R methods, for several numbers of sensors,
+ *      numbers of values, with and without CRC and for several measurement
+ *      times; C sweeps run with the default number of concurrent requests
+ *      and, if there are more sensors, with one request per sensor. The
+ *      sensors finish their measurement at 3/4 of the announced time (M
+ *      returns earlier thanks to the service request). Reported are the
+ *      duration of a sweep, the bus occupancy, the number of breaks and the
+ *      time spent in breaks, and the percentiles of the per-sensor latency
+ *      (from request to data delivery), all in simulated time.
+ */
+static void
+bench_sweep (void)
+{
+  static const char methods[] =
+    { sdi12_dr::measure, sdi12_dr::concurrent, sdi12_dr::continuous };
+  static const int counts[] =
+    { 1, 8, 32, 62 };
+  static const uint8_t values[] =
+    { 3, 9 };
+  static const uint16_t ttts[] =
+    { 1, 3 };
+
+  sweep_bus.set_clock (&sweep_clock);
+  sweep_dr.set_clock (&sweep_clock);
+  sweep_clock.attach ();
+
+  if (sweep_dr.open (1200, CS7, PARENB, 50) == false)
+    {
+      trace::printf ("# sweep: %s\n", sweep_dr.error->error_text);
+    }
+  else
+    {
+      trace::printf ("# method,sensors,values,crc,ttt,slots,sweep_ms,"
+                     "busy_pct,breaks,break_pct,p50_ms,p90_ms,p99_ms,max_ms,"
+                     "errors\n");
+
+      for (char m : methods)
+        for (int n : counts)
+          for (uint8_t v : values)
+            for (int crc = 0; crc < 2; crc++)
+              for (uint16_t ttt : ttts)
+                {
+                  if (m == sdi12_dr::continuous && ttt != ttts[0])
+                    {
+                      continue;   // no measurement time
+                    }
+                  sweep_scenario (m, n, v, crc, ttt, MAX_CONCURRENT_REQUESTS);
+#if MAX_CONCURRENT_REQUESTS > 0
+                  if (m == sdi12_dr::concurrent && n > MAX_CONCURRENT_REQUESTS)
+                    {
+                      sweep_scenario (m, n, v, crc, ttt, n);
+                    }
+#endif
+                }
+#if MAX_CONCURRENT_REQUESTS > 0
+      sweep_dr.set_max_concurrent (MAX_CONCURRENT_REQUESTS);
+#endif
+      sweep_dr.close ();
+    }
+
+  sweep_clock.detach ();
+  sweep_dr.set_clock (nullptr);
+  sweep_bus.set_clock (nullptr);
+}
+
+/**
+ * @brief Sweep a bus where every other sensor measures concurrently, either
+ *      with one retrieve() per sensor in address order, or with a single
+ *      planned retrieve_many().
+ * @return the number of failed retrievals.
+ */
+static int
+plan_sweep (int sensors, bool planned, int& samples)
+{
+  dacq::dacq_handle_t* handles[sdi12_dr::max_addresses];
+  int errors = 0;
+
+  for (int i = 0; i < sensors; i++)
+    {
+      sweep_sensor_t* s = &sweep_sensors[i];
+      sweep_request (s, sdi12_dr::index_to_addr (i),
+                     i & 1 ? sdi12_dr::concurrent : sdi12_dr::measure, false);
+      s->dh.cb = sweep_cb;
+      handles[i] = &s->dh;
+    }
+
+  if (planned)
+    {
+      errors = sweep_dr.retrieve_many (handles, sensors) ? 0 : 1;
+    }
+  else
+    {
+      for (int i = 0; i < sensors; i++)
+        {
+          while (sweep_dr.retrieve (handles[i]) == false)
+            {
+              if (sweep_dr.error->error_number != dacq::too_many_requests
+                  && sweep_dr.error->error_number != dacq::dacq_busy)
+                {
+                  errors++;
+                  break;
+                }
+              sweep_clock.sleep_for (100);
+            }
+        }
+    }
+
+  // all call-backs, sequential ones included, post the semaphore
+  for (int i = errors; i < sensors; i++)
+    {
+      if (sweep_clock.timed_wait (sweep_sem, 20000) != 0)
+        {
+          errors += sensors - i;
+          break;
+        }
+      sweep_latency[samples++] = sweep_sensors[i].latency;
+    }
+
+  return errors;
+}
+
+/**
+ * @brief Sweep planner benchmark: a simulated bus with "M" and "C" sensors
+ *      in equal numbers, swept with one retrieve() per sensor in address
+ *      order ("ordered") and with retrieve_many() ("planned").
+ */
+static void
+bench_plan (void)
+{
+  static const int counts[] =
+    { 8, 32, 62 };
+  static const uint16_t ttts[] =
+    { 1, 3 };
+  static const char* names[] =
+    { "ordered", "planned" };
+
+  sweep_bus.set_clock (&sweep_clock);
+  sweep_dr.set_clock (&sweep_clock);
+  sweep_clock.attach ();
+
+  if (sweep_dr.open (1200, CS7, PARENB, 50) == false)
+    {
+      trace::printf ("# plan: %s\n", sweep_dr.error->error_text);
+    }
+  else
+    {
+      trace::printf ("# sensors,ttt,variant,sweep_ms,busy_pct,p50_ms,max_ms,"
+                     "errors\n");
+      for (int n : counts)
+        for (uint16_t ttt : ttts)
+          for (int v = 0; v < 2; v++)
+            {
+              for (int i = 0; i < sdi12_dr::max_addresses; i++)
+                {
+                  char addr = sdi12_dr::index_to_addr (i);
+                  if (i < n)
+                    {
+                      sdi12_sim::sensor_t* s = sweep_bus.add (addr);
+                      s->ttt = ttt;
+                      s->ready = ttt * 750;
+                    }
+                  else
+                    {
+                      sweep_bus.remove (addr);
+                    }
+                }
+              sweep_bus.reset_stats ();
+
+              int samples = 0;
+              int errors = 0;
+              clock::timestamp_t start = sweep_clock.now ();
+              for (int r = 0; r < sweep_rounds; r++)
+                {
+                  errors += plan_sweep (n, v, samples);
+                }
+              uint64_t total = sweep_clock.now () - start;
+
+              qsort (sweep_latency, samples, sizeof(uint32_t), sweep_compare);
+              uint32_t busy = total ? sweep_bus.stats ().busy / total : 0;
+              trace::printf ("%d,%u,%s,%u,%u.%u,%u,%u,%d\n", n, ttt, names[v],
+                             (uint32_t) (total / sweep_rounds), busy / 10,
+                             busy % 10,
+                             samples ? sweep_latency[(samples - 1) / 2] : 0,
+                             samples ? sweep_latency[samples - 1] : 0, errors);
+            }
+      sweep_dr.close ();
+    }
+
+  sweep_clock.detach ();
+  sweep_dr.set_clock (nullptr);
+  sweep_bus.set_clock (nullptr);
+}
+
+/**
+ * @brief Service request benchmark: consecutive "M" measurements of a
+ *      sensor that sends its service request on time, then of the same
+ *      sensor sending it 300 ms late, then not at all, showing how the
+ *      grace period after the announced time is learned.
+ */
+static void
+bench_service_request (void)
+{
+  static const char* names[] =
+    { "on_time", "late_300ms", "none" };
+  static const uint16_t readies[] =
+    { 750, 1300, 1000 };
+  static constexpr int measurements = 4;
+
+  sweep_bus.set_clock (&sweep_clock);
+  sweep_dr.set_clock (&sweep_clock);
+  sweep_clock.attach ();
+
+  if (sweep_dr.open (1200, CS7, PARENB, 50) == false)
+    {
+      trace::printf ("# sr: %s\n", sweep_dr.error->error_text);
+    }
+  else
+    {
+      trace::printf ("# service_request,measurement,ms,ok\n");
+      for (int i = 0; i < sdi12_dr::max_addresses; i++)
+        {
+          sweep_bus.remove (sdi12_dr::index_to_addr (i));
+        }
+      sdi12_sim::sensor_t* s = sweep_bus.add ('0');
+      sweep_clock.sleep_for (200);      // the new sensor needs a break
+      for (int v = 0; v < 3; v++)
+        {
+          s->ready = readies[v];
+          s->service_request = v != 2;
+          for (int m = 0; m < measurements; m++)
+            {
+              sweep_sensor_t* ss = &sweep_sensors[0];
+              sweep_request (ss, '0', sdi12_dr::measure, false);
+              bool ok = sweep_dr.retrieve (&ss->dh);
+              trace::printf ("%s,%d,%u,%d\n", names[v], m,
+                             (uint32_t) (sweep_clock.now () - ss->start), ok);
+              sweep_clock.sleep_for (200);
+            }
+        }
+      sweep_dr.close ();
+    }
+
+  sweep_clock.detach ();
+  sweep_dr.set_clock (nullptr);
+  sweep_bus.set_clock (nullptr);
+}
+
+/**
+ * @brief High volume benchmark: a single sensor returning 100 to 999 values
+ *      with a high volume measurement, as ASCII pages ("HA", always with
+ *      CRC) and as binary packets ("HB", float32 and int16 values).
+ *      Reported are the duration of the retrieval, the time the line was
+ *      busy and the values received per second; the measurement time is 0.
+ */
+static void
+bench_volume (void)
+{
+  static const uint16_t counts[] =
+    { 100, 250, 999 };
+  static const char* names[] =
+    { "ascii", "float32", "int16" };
+  static float data[999];
+  static uint8_t status[999];
+
+  sweep_bus.set_clock (&sweep_clock);
+  sweep_dr.set_clock (&sweep_clock);
+  sweep_clock.attach ();
+
+  if (sweep_dr.open (1200, CS7, PARENB, 50) == false)
+    {
+      trace::printf ("# volume: %s\n", sweep_dr.error->error_text);
+    }
+  else
+    {
+      trace::printf ("# variant,values,ms,busy_ms,values_per_s,ok\n");
+      for (int i = 0; i < sdi12_dr::max_addresses; i++)
+        {
+          sweep_bus.remove (sdi12_dr::index_to_addr (i));
+        }
+      sdi12_sim::sensor_t* s = sweep_bus.add ('0');
+      s->ttt = 0;
+      for (int v = 0; v < 3; v++)
+        {
+          for (uint16_t count : counts)
+            {
+              sweep_sensor_t* ss = &sweep_sensors[0];
+              sweep_request (ss, '0',
+                             v == 0 ? sdi12_dr::high_volume_ascii :
+                                      sdi12_dr::high_volume_binary,
+                             false);
+              ss->dh.data = data;
+              ss->dh.status = status;
+              ss->dh.data_count = count;
+              s->values = count;
+              s->binary_type =
+                  v == 2 ? sdi12_binary::int16 : sdi12_binary::float32;
+              sweep_clock.sleep_for (200);
+              sweep_bus.reset_stats ();
+              ss->start = sweep_clock.now ();
+              bool ok = sweep_dr.retrieve (&ss->dh)
+                  && ss->dh.data_count == count;
+              uint32_t ms = sweep_clock.now () - ss->start;
+              trace::printf ("%s,%u,%u,%u,%u,%d\n", names[v], count, ms,
+                             (uint32_t) (sweep_bus.stats ().busy / 1000),
+                             ms ? count * 1000 / ms : 0, ok);
+            }
+        }
+      sweep_dr.close ();
+    }
+
+  sweep_clock.detach ();
+  sweep_dr.set_clock (nullptr);
+  sweep_bus.set_clock (nullptr);
+}
+
+/**
+ * @brief Discovery benchmark: a simulated bus with 0, 1, 8 and 62 sensors,
+ *      scanned with get_info() on every address ("get_info"), with
+ *      discover() ("discover") and with discover() starting with the "?!"
+ *      wildcard ("wildcard"). Reported are the duration of the scan and the
+ *      number of sensors found.
+ */
+static void
+bench_discover (void)
+{
+  static const int sizes[] =
+    { 0, 1, 8, sdi12_dr::max_addresses };
+  static const char* names[] =
+    { "get_info", "discover", "wildcard" };
+  char info[48];
+
+  sweep_bus.set_clock (&sweep_clock);
+  sweep_dr.set_clock (&sweep_clock);
+  sweep_clock.attach ();
+
+  if (sweep_dr.open (1200, CS7, PARENB, 50) == false)
+    {
+      trace::printf ("# discover: %s\n", sweep_dr.error->error_text);
+    }
+  else
+    {
+      trace::printf ("# sensors,variant,ms,found,ok\n");
+      for (int n : sizes)
+        {
+          for (int i = 0; i < sdi12_dr::max_addresses; i++)
+            {
+              sweep_bus.remove (sdi12_dr::index_to_addr (i));
+            }
+          for (int i = 0; i < n; i++)
+            {
+              sweep_bus.add (sdi12_dr::index_to_addr (i));
+            }
+          for (int v = 0; v < 3; v++)
+            {
+              uint64_t found = 0;
+              bool ok = true;
+              sweep_clock.sleep_for (200);
+              clock::timestamp_t start = sweep_clock.now ();
+              if (v == 0)
+                {
+                  for (int i = 0; i < sdi12_dr::max_addresses; i++)
+                    {
+                      if (sweep_dr.get_info (sdi12_dr::index_to_addr (i), info,
+                                             sizeof(info)) == true)
+                        {
+                          found |= 1ULL << i;
+                        }
+                    }
+                }
+              else
+                {
+                  ok = sweep_dr.discover (found, v == 2);
+                }
+              uint32_t ms = sweep_clock.now () - start;
+              int count = __builtin_popcountll (found);
+              trace::printf ("%d,%s,%u,%d,%d\n", n, names[v], ms, count,
+                             ok && count == n);
+            }
+        }
+      sweep_dr.close ();
+    }
+
+  sweep_clock.detach ();
+  sweep_dr.set_clock (nullptr);
+  sweep_bus.set_clock (nullptr);
+}
+
+/*
+ * Retry policy with the budget used up to version 1.5.4: every command is
+ * sent three times, three times over, whatever the history of the sensor.
+ */
+class fixed_retry : public sdi12_retry_policy
+{
+public:
+
+  int
+  rounds (int index, clock::timestamp_t now) override
+  {
+    (void) index;
+    (void) now;
+    return full_rounds;
+  }
+
+  int
+  attempts (int index, clock::timestamp_t now) override
+  {
+    (void) index;
+    (void) now;
+    return full_attempts;
+  }
+
+  void
+  result (int index, bool answered, clock::timestamp_t now) override
+  {
+    (void) index;
+    (void) answered;
+    (void) now;
+  }
+
+};
+
+/**
+ * @brief Retry policy benchmark: 8 "M" sensors, of which 0, 1 or 4 are
+ *      not on the bus, swept 10 times, 10 seconds apart, with the fixed
+ *      retry budget ("fixed") and with the default adaptive policy
+ *      ("adaptive"). Reported are the average duration of a sweep, and, for
+ *      the dead sensors, the commands not sent and the bus time saved, as
+ *      counted by sdi12_stats.
+ */
+static void
+bench_retry (void)
+{
+  static const int dead[] =
+    { 0, 1, 4 };
+  static const char* names[] =
+    { "fixed", "adaptive" };
+  static constexpr int sensors = 8;
+  static constexpr int sweeps = 10;
+  static fixed_retry fixed;
+  static sdi12_retry_policy adaptive;
+  static sdi12_stats stats;
+  sdi12_stats::entry_t entry = { };
+
+  sweep_bus.set_clock (&sweep_clock);
+  sweep_dr.set_clock (&sweep_clock);
+  sweep_clock.attach ();
+
+  if (sweep_dr.open (1200, CS7, PARENB, 50) == false)
+    {
+      trace::printf ("# retry: %s\n", sweep_dr.error->error_text);
+    }
+  else
+    {
+      trace::printf ("# dead,policy,sweep_ms,skipped,saved_ms,errors\n");
+      sweep_dr.set_stats (&stats);
+      for (int d : dead)
+        {
+          for (int i = 0; i < sdi12_dr::max_addresses; i++)
+            {
+              sweep_bus.remove (sdi12_dr::index_to_addr (i));
+            }
+          // the dead sensors are the last ones
+          for (int i = 0; i < sensors - d; i++)
+            {
+              sweep_bus.add (sdi12_dr::index_to_addr (i));
+            }
+          for (int v = 0; v < 2; v++)
+            {
+              adaptive.reset ();
+              sweep_dr.set_retry_policy (v == 0 ? &fixed : &adaptive);
+              stats.reset ();
+              int errors = 0;
+              uint64_t total = 0;
+              for (int k = 0; k < sweeps; k++)
+                {
+                  sweep_clock.sleep_for (10000);
+                  clock::timestamp_t start = sweep_clock.now ();
+                  for (int i = 0; i < sensors; i++)
+                    {
+                      sweep_sensor_t* ss = &sweep_sensors[i];
+                      sweep_request (ss, sdi12_dr::index_to_addr (i),
+                                     sdi12_dr::measure, false);
+                      errors += !sweep_dr.retrieve (&ss->dh);
+                    }
+                  total += sweep_clock.now () - start;
+                }
+              uint32_t skipped = 0;
+              uint64_t saved = 0;
+              for (int i = sensors - d; i < sensors; i++)
+                {
+                  stats.snapshot (i, entry);
+                  skipped += entry.count[sdi12_stats::skipped];
+                  saved += entry.saved_ms;
+                }
+              trace::printf ("%d,%s,%u,%u,%u,%d\n", d, names[v],
+                             (uint32_t) (total / sweeps), skipped,
+                             (uint32_t) saved, errors - d * sweeps);
+            }
+        }
+      sweep_dr.set_retry_policy (nullptr);
+      sweep_dr.set_stats (nullptr);
+      sweep_dr.close ();
+    }
+
+  sweep_clock.detach ();
+  sweep_dr.set_clock (nullptr);
+  sweep_bus.set_clock (nullptr);
+}
+
+static dacq_dispatch_thread dispatch_thread;
+static uint32_t dispatch_cb_ms;
+
+/*
+ * Call-back doing some slow processing of the data (e.g. storing it).
+ */
+static bool
+dispatch_cb (void* param)
+{
+  dacq::dacq_handle_t* dh = static_cast<dacq::dacq_handle_t*> (param);
+  sweep_sensor_t* s = static_cast<sweep_sensor_t*> (dh->cb_parameter);
+
+  sweep_clock.sleep_for (dispatch_cb_ms);
+  s->latency = sweep_clock.now () - s->start;
+  sweep_sem.post ();
+  return true;
+}
+
+/**
+ * @brief Dispatch benchmark: a bus of "M" sensors swept with retrieve_many(),
+ *      with a slow call-back called with the bus locked ("inline") and
+ *      deferred to a dispatch thread ("queued"); sweep_ms is the time until
+ *      the sweep returned, done_ms until the last call-back returned.
+ */
+static void
+bench_dispatch (void)
+{
+  static const int counts[] =
+    { 8, 32 };
+  static const uint32_t cb_times[] =
+    { 100, 1000 };
+  static const char* names[] =
+    { "inline", "queued" };
+
+  sweep_bus.set_clock (&sweep_clock);
+  sweep_dr.set_clock (&sweep_clock);
+  dispatch_thread.set_clock (&sweep_clock);
+  sweep_clock.attach ();
+
+  if (sweep_dr.open (1200, CS7, PARENB, 50) == false)
+    {
+      trace::printf ("# dispatch: %s\n", sweep_dr.error->error_text);
+    }
+  else
+    {
+      trace::printf ("# sensors,callback_ms,variant,sweep_ms,done_ms,"
+                     "high_water,overflows,errors\n");
+      for (int n : counts)
+        for (uint32_t cb_ms : cb_times)
+          for (int v = 0; v < 2; v++)
+            {
+              dacq::dacq_handle_t* handles[sdi12_dr::max_addresses];
+              for (int i = 0; i < sdi12_dr::max_addresses; i++)
+                {
+                  char addr = sdi12_dr::index_to_addr (i);
+                  if (i < n)
+                    {
+                      sdi12_sim::sensor_t* s = sweep_bus.add (addr);
+                      s->ttt = 1;
+                      s->ready = 750;
+                    }
+                  else
+                    {
+                      sweep_bus.remove (addr);
+                    }
+                }
+              sweep_clock.sleep_for (200);      // new sensors need a break
+              for (int i = 0; i < n; i++)
+                {
+                  sweep_sensor_t* s = &sweep_sensors[i];
+                  sweep_request (s, sdi12_dr::index_to_addr (i),
+                                 sdi12_dr::measure, false);
+                  s->dh.cb = dispatch_cb;
+                  handles[i] = &s->dh;
+                }
+              dispatch_cb_ms = cb_ms;
+              dispatch_thread.reset_stats ();
+              sweep_dr.set_dispatch (v ? &dispatch_thread : nullptr);
+
+              clock::timestamp_t start = sweep_clock.now ();
+              int errors = sweep_dr.retrieve_many (handles, n) ? 0 : 1;
+              uint32_t swept = sweep_clock.now () - start;
+              for (int i = 0; i < n; i++)
+                {
+                  if (sweep_clock.timed_wait (sweep_sem, 60000) != 0)
+                    {
+                      errors += n - i;
+                      break;
+                    }
+                }
+              uint32_t done = sweep_clock.now () - start;
+              sweep_dr.set_dispatch (nullptr);
+
+              trace::printf ("%d,%u,%s,%u,%u,%u,%u,%d\n", n, cb_ms, names[v],
+                             swept, done, dispatch_thread.stats ().high_water,
+                             dispatch_thread.stats ().overflows, errors);
+            }
+      sweep_dr.close ();
+    }
+
+  sweep_clock.detach ();
+  dispatch_thread.set_clock (nullptr);
+  sweep_dr.set_clock (nullptr);
+  sweep_bus.set_clock (nullptr);
+}
+
+#if MAX_CONCURRENT_REQUESTS > 0
+// several simulated buses, sharing the clock of the sweeps
+static constexpr int max_buses = 4;
+static constexpr int bus_sensors = 16;
+static sdi12_sim bus_sims[max_buses];
+static sdi12_dr bus_drs[max_buses] =
+  {
+    { bus_sims[0] },
+    { bus_sims[1] },
+    { bus_sims[2] },
+    { bus_sims[3] } };
+static sweep_sensor_t bus_requests[max_buses][bus_sensors];
+
+/**
+ * @brief Multi-bus benchmark: 1 to 4 simulated buses with 16 sensors each,
+ *      half of them "M" and half "C", swept one bus after the other with
+ *      retrieve_many() ("serial"), or all buses in parallel by a manager
+ *      ("parallel"). Reported are the duration of a sweep and the number
+ *      of sensors retrieved per minute.
+ */
+static void
+bench_buses (void)
+{
+  static const char* names[] =
+    { "serial", "parallel" };
+  static sdi12_dr* drs[max_buses] =
+    { &bus_drs[0], &bus_drs[1], &bus_drs[2], &bus_drs[3] };
+  static sdi12_manager manager
+    { drs, max_buses };
+  dacq::dacq_handle_t* handles[bus_sensors];
+  bool ok = true;
+
+  sweep_clock.attach ();
+  manager.set_clock (&sweep_clock);
+  for (int b = 0; b < max_buses; b++)
+    {
+      bus_sims[b].set_clock (&sweep_clock);
+      bus_drs[b].set_clock (&sweep_clock);
+      ok = ok && bus_drs[b].open (1200, CS7, PARENB, 50);
+      for (int i = 0; i < bus_sensors; i++)
+        {
+          sdi12_sim::sensor_t* s = bus_sims[b].add (
+              sdi12_dr::index_to_addr (i));
+          s->ready = 750;
+        }
+    }
+
+  if (ok == false)
+    {
+      trace::printf ("# buses: open failed\n");
+    }
+  else
+    {
+      trace::printf ("# buses,sensors,variant,sweep_ms,sensors_per_min,"
+                     "errors\n");
+      for (int n = 1; n <= max_buses; n *= 2)
+        for (int v = 0; v < 2; v++)
+          {
+            // only the first n buses have sensors registered
+            for (int b = 0; b < max_buses; b++)
+              {
+                for (int i = 0; i < bus_sensors; i++)
+                  {
+                    sweep_sensor_t* s = &bus_requests[b][i];
+                    char addr = sdi12_dr::index_to_addr (i);
+                    manager.remove (b, addr);
+                    sweep_request (
+                        s, addr,
+                        i & 1 ? sdi12_dr::concurrent : sdi12_dr::measure,
+                        false);
+                    if (b < n)
+                      {
+                        manager.add (b, &s->dh);
+                      }
+                  }
+              }
+            sweep_clock.sleep_for (200);
+
+            int errors = 0;
+            clock::timestamp_t start = sweep_clock.now ();
+            if (v == 0)
+              {
+                for (int b = 0; b < n; b++)
+                  {
+                    for (int i = 0; i < bus_sensors; i++)
+                      {
+                        handles[i] = &bus_requests[b][i].dh;
+                      }
+                    errors += !bus_drs[b].retrieve_many (handles, bus_sensors);
+                  }
+              }
+            else
+              {
+                errors += !manager.run (120000);
+              }
+            uint32_t ms = sweep_clock.now () - start;
+
+            trace::printf ("%d,%d,%s,%u,%u,%d\n", n, n * bus_sensors,
+                           names[v], ms,
+                           ms ? (uint32_t) (n * bus_sensors * 60000ULL / ms) : 0,
+                           errors);
+          }
+    }
+
+  for (int b = 0; b < max_buses; b++)
+    {
+      bus_drs[b].close ();
+      bus_drs[b].set_clock (nullptr);
+      bus_sims[b].set_clock (nullptr);
+    }
+  sweep_clock.detach ();
+}
+#endif
+
+/**
+ * @brief Run all SDI-12 benchmarks.
+ */
+void
+bench_sdi12 (void)
+{
+  trace::printf ("SDI-12 benchmarks\n");
+
+  bench_frame ();
+  bench_crc ();
+  bench_parser ();
+  bench_deadline ();
+  bench_trace ();
+  bench_sweep ();
+  bench_plan ();
+  bench_service_request ();
+  bench_volume ();
+  bench_discover ();
+  bench_retry ();
+  bench_dispatch ();
+#if MAX_CONCURRENT_REQUESTS > 0
+  bench_buses ();
+#endif
+
+  trace::printf ("SDI-12 benchmarks done\n");
+}
+
+#endif // SDI12_BENCH == true
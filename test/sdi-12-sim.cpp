@@ -0,0 +1,817 @@
+/*
+ * sdi-12-sim.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "sdi-12-sim.h"
+#include "sdi-12-crc.h"
+
+using namespace os;
+using namespace os::rtos;
+
+/**
+ * @brief Constructor.
+ * @param seed: seed of the random generator used for jitter, lost bytes
+ *      and corrupted answers; runs with the same seed are identical.
+ */
+sdi12_sim::sdi12_sim (uint32_t seed)
+{
+  memset (sensors_, 0, sizeof(sensors_));
+  memset (states_, 0, sizeof(states_));
+  memset (&stats_, 0, sizeof(stats_));
+  seed_ = seed ? seed : 1;
+  origin_ = clock_->now ();
+}
+
+/**
+ * @brief Connect a sensor to the bus, with a default configuration: one
+ *      second measurement time, three values, CRC and service request
+ *      support, no noise. The configuration can then be changed using the
+ *      returned pointer.
+ * @param addr: sensor's address.
+ * @return a pointer to the sensor's configuration, or nullptr if the
+ *      address is not valid.
+ */
+sdi12_sim::sensor_t*
+sdi12_sim::add (char addr)
+{
+  int idx = sdi12_dr::addr_to_index (addr);
+
+  if (idx < 0)
+    {
+      return nullptr;
+    }
+  sensors_[idx] =
+    { true, 1, 0, 3, true, true, 9, 0, 0, 0, sdi12_binary::float32 };
+  memset (&states_[idx], 0, sizeof(state_t));
+
+  return &sensors_[idx];
+}
+
+/**
+ * @brief Disconnect a sensor from the bus.
+ * @param addr: sensor's address.
+ */
+void
+sdi12_sim::remove (char addr)
+{
+  int idx = sdi12_dr::addr_to_index (addr);
+
+  if (idx >= 0)
+    {
+      sensors_[idx].present = false;
+    }
+}
+
+/**
+ * @brief Return a value of the last measurement of a sensor, as it should be
+ *      decoded by the driver.
+ * @param addr: sensor's address.
+ * @param index: value's index.
+ * @return the value.
+ */
+float
+sdi12_sim::value (char addr, int index)
+{
+  char buff[8];
+  int idx = sdi12_dr::addr_to_index (addr);
+
+  if (idx < 0)
+    {
+      return 0;
+    }
+  format (idx, index, buff);
+
+  int32_t mantissa = 0;
+  for (const char* p = buff + 1; *p; p++)
+    {
+      if (*p != '.')
+        {
+          mantissa = mantissa * 10 + (*p - '0');
+        }
+    }
+
+  return (buff[0] == '-' ? -mantissa : mantissa) / 100.0f;
+}
+
+/**
+ * @brief Clear the bus statistics.
+ */
+void
+sdi12_sim::reset_stats (void)
+{
+  memset (&stats_, 0, sizeof(stats_));
+}
+
+/**
+ * @brief Return the bus time, in µs since the simulator was created.
+ */
+uint64_t
+sdi12_sim::now_us (void)
+{
+  return (uint64_t) (clock_->now () - origin_) * 1000;
+}
+
+/**
+ * @brief Install the time source of the bus; it must be the same as the
+ *      driver's. The bus time restarts from 0, so call it before the bus is
+ *      used.
+ * @param clock: pointer to the clock; if nullptr, the system clock is
+ *      restored.
+ */
+void
+sdi12_sim::set_clock (dacq_clock* clock)
+{
+  clock_ = clock ? clock : &default_clock_;
+  origin_ = clock_->now ();
+  line_free_ = awake_until_ = 0;
+}
+
+bool
+sdi12_sim::open (void)
+{
+  open_ = true;
+  return true;
+}
+
+void
+sdi12_sim::close (void)
+{
+  open_ = false;
+}
+
+bool
+sdi12_sim::set_attributes (speed_t baudrate __attribute__((unused)),
+                           uint32_t c_size, uint32_t parity,
+                           uint32_t rec_timeout)
+{
+  rec_timeout_ = rec_timeout;
+  eight_bits_ = c_size == CS8 && (parity & PARENB) == 0;
+  return open_;
+}
+
+/**
+ * @brief Read the answer bytes received so far, waiting at most 'timeout'
+ *      ms for the first one.
+ */
+ssize_t
+sdi12_sim::read (void* buff, size_t count, uint32_t timeout)
+{
+  if (open_ == false)
+    {
+      return -1;
+    }
+
+  uint64_t deadline = now_us () + timeout * 1000ULL;
+  service_requests (deadline);
+
+  if (rx_count_ == 0 || rx_[rx_head_].time > deadline)
+    {
+      wait_until (deadline);
+      return 0;
+    }
+  wait_until (rx_[rx_head_].time);
+
+  uint64_t now = now_us ();
+  char* p = static_cast<char*> (buff);
+  size_t n = 0;
+  while (n < count && rx_count_ > 0 && rx_[rx_head_].time <= now)
+    {
+      p[n++] = receive (rx_[rx_head_]);
+      rx_head_ = (rx_head_ + 1) % rx_size;
+      rx_count_--;
+    }
+
+  return n;
+}
+
+/**
+ * @brief Write command bytes to the bus; a command is executed by the
+ *      sensors as soon as its final '!' has been written.
+ */
+ssize_t
+sdi12_sim::write (const void* buff, size_t count)
+{
+  if (open_ == false)
+    {
+      return -1;
+    }
+
+  const char* p = static_cast<const char*> (buff);
+  uint64_t now = now_us ();
+  for (size_t i = 0; i < count; i++)
+    {
+      if (cmd_len_ == 0)
+        {
+          cmd_start_ = now + i * char_time;
+        }
+      cmd_[cmd_len_++] = p[i];
+      if (p[i] == '!')
+        {
+          command (cmd_start_);
+          cmd_len_ = 0;
+        }
+      else if (cmd_len_ == cmd_size)
+        {
+          cmd_len_ = 0;
+        }
+    }
+
+  return count;
+}
+
+/**
+ * @brief Send a break, which wakes up all the sensors.
+ */
+int
+sdi12_sim::send_break (int duration)
+{
+  uint64_t start = now_us ();
+  uint64_t end = start + duration * 1000ULL;
+
+  stats_.breaks++;
+  stats_.busy += end - start;
+  stats_.break_time += end - start;
+  line_free_ = std::max (line_free_, end);
+  awake_until_ = end + sleep_time;
+  cmd_len_ = 0;
+  wait_until (end);
+
+  return 0;
+}
+
+/**
+ * @brief Discard the bytes already received and/or a partial command.
+ */
+int
+sdi12_sim::flush (int queue)
+{
+  if (queue == TCIFLUSH || queue == TCIOFLUSH)
+    {
+      uint64_t now = now_us ();
+      while (rx_count_ > 0 && rx_[rx_head_].time <= now)
+        {
+          rx_head_ = (rx_head_ + 1) % rx_size;
+          rx_count_--;
+        }
+    }
+  if (queue == TCOFLUSH || queue == TCIOFLUSH)
+    {
+      cmd_len_ = 0;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+
+/**
+ * @brief Execute the command in cmd_.
+ * @param start: time the command started to be transmitted, in µs.
+ */
+void
+sdi12_sim::command (uint64_t start)
+{
+  uint64_t end = start + cmd_len_ * char_time;
+
+  stats_.commands++;
+  stats_.busy += cmd_len_ * char_time;
+  line_free_ = std::max (line_free_, end);
+  if (start > awake_until_)
+    {
+      // the line was marking for too long, all sensors are asleep
+      stats_.ignored++;
+      return;
+    }
+  awake_until_ = end + sleep_time;
+
+  const char* p = cmd_ + 1;
+  size_t n = cmd_len_ - 2;      // without address and '!'
+
+  if (cmd_[0] == '?')
+    {
+      int found = -1;
+      for (int i = 0; i < max_sensors && n == 0; i++)
+        {
+          if (sensors_[i].present)
+            {
+              if (found >= 0)
+                {
+                  // several sensors answer at once: a collision
+                  char text[2] =
+                    { (char) random (128), (char) random (128) };
+                  answer (found, text, sizeof(text), false, end);
+                  return;
+                }
+              found = i;
+            }
+        }
+      if (found >= 0)
+        {
+          char a = sdi12_dr::index_to_addr (found);
+          answer (found, &a, 1, false, end);
+        }
+      return;
+    }
+
+  int idx = sdi12_dr::addr_to_index (cmd_[0]);
+  if (idx < 0 || sensors_[idx].present == false)
+    {
+      return;
+    }
+  sensor_t& s = sensors_[idx];
+  state_t& st = states_[idx];
+  st.sr_pending = false;        // any command aborts a pending measurement
+  char m_kind;
+  uint8_t m_index;
+  bool m_crc;
+
+  if (n == 0)
+    {
+      answer (idx, cmd_, 1, false, end);
+    }
+  else if (n == 1 && p[0] == 'I')
+    {
+      char text[40];
+      int len = snprintf (text, sizeof(text), "%c13VIRTUAL SDI12S100SN%02d",
+                          cmd_[0], idx);
+      answer (idx, text, len, false, end);
+    }
+  else if (n == 2 && p[0] == 'A')
+    {
+      int new_idx = sdi12_dr::addr_to_index (p[1]);
+      if (new_idx >= 0 && (new_idx == idx || !sensors_[new_idx].present))
+        {
+          sensors_[new_idx] = s;
+          states_[new_idx] = st;
+          if (new_idx != idx)
+            {
+              s.present = false;
+            }
+          answer (new_idx, p + 1, 1, false, end);
+        }
+    }
+  else if (n > 1 && p[0] == 'I')
+    {
+      // metadata: aI<measurement>! or aI<measurement>_nnn!
+      const char* u = static_cast<const char*> (memchr (p, '_', n));
+      size_t m = u != nullptr ? u - p : n;
+      char kind;
+      uint8_t index;
+      bool crc;
+      if (measurement (p + 1, m - 1, kind, index, crc) == false
+          || (crc && s.crc == false))
+        {
+          return;       // not recognised
+        }
+      char text[24];
+      int len;
+      uint16_t count = values (idx, kind);
+      if (u == nullptr)
+        {
+          len = snprintf (text, sizeof(text), "%c%03u%0*u", cmd_[0],
+                          kind == 'R' ? 0 : s.ttt % 1000,
+                          kind == 'H' || kind == 'B' ? 3 :
+                          kind == 'C' || kind == 'R' ? 2 : 1,
+                          count);
+          answer (idx, text, len, false, end);
+          return;
+        }
+      int param = 0;
+      if (n - m != 4)
+        {
+          return;       // not recognised
+        }
+      for (size_t k = m + 1; k < n; k++)
+        {
+          if (p[k] < '0' || p[k] > '9')
+            {
+              return;   // not recognised
+            }
+          param = param * 10 + p[k] - '0';
+        }
+      if (param >= 1 && param <= count)
+        {
+          len = snprintf (text, sizeof(text), "%c,P%u,U%u;", cmd_[0], param,
+                          param % 3);
+        }
+      else
+        {
+          len = 1;      // no such parameter
+          text[0] = cmd_[0];
+        }
+      answer (idx, text, len, crc, end);
+    }
+  else if (measurement (p, n, m_kind, m_index, m_crc))
+    {
+      if (m_crc && s.crc == false)
+        {
+          return;       // not recognised
+        }
+      // high volume ASCII data pages always carry a CRC
+      measure (idx, m_kind, m_index, m_kind == 'H' || m_crc, end);
+    }
+  else if (n >= 2 && p[0] == 'D')
+    {
+      bool binary = p[1] == 'B';
+      size_t k = binary ? 2 : 1;
+      int page = 0;
+      if (k == n || n - k > 3)
+        {
+          return;       // not recognised
+        }
+      for (; k < n; k++)
+        {
+          if (p[k] < '0' || p[k] > '9')
+            {
+              return;   // not recognised
+            }
+          page = page * 10 + p[k] - '0';
+        }
+      if (binary && st.kind == 'B')
+        {
+          packet (idx, page, end);
+        }
+      else if (!binary && (page < 10 || st.kind == 'H'))
+        {
+          data (idx, page, end);
+        }
+    }
+}
+
+/**
+ * @brief Parse a measurement command (without address and '!'): M, MC, Mn,
+ *      MCn, C, CC, Cn, CCn, V, Rn, RCn, HA or HB.
+ * @param p: the command.
+ * @param n: command length.
+ * @param kind: returns the measurement, 'H' for HA and 'B' for HB.
+ * @param index: returns the additional measurement index.
+ * @param crc: returns true if the CRC variant was requested.
+ * @return true if the command was recognised, false otherwise.
+ */
+bool
+sdi12_sim::measurement (const char* p, size_t n, char& kind, uint8_t& index,
+                        bool& crc)
+{
+  size_t k = 1;
+
+  kind = n > 0 ? p[0] : 0;
+  index = 0;
+  crc = false;
+  if (n == 2 && kind == 'H' && (p[1] == 'A' || p[1] == 'B'))
+    {
+      kind = p[1] == 'A' ? 'H' : 'B';
+      return true;
+    }
+  if (kind != 'M' && kind != 'C' && kind != 'V' && kind != 'R')
+    {
+      return false;
+    }
+  if (kind != 'V' && k < n && p[k] == 'C')
+    {
+      crc = true;
+      k++;
+    }
+  if (kind != 'V' && k < n && p[k] >= '0' && p[k] <= '9')
+    {
+      index = p[k++] - '0';
+    }
+  else if (kind == 'R')
+    {
+      return false;     // R requires an index
+    }
+  return k == n;
+}
+
+/**
+ * @brief Return the number of values a sensor returns for a measurement,
+ *      limited as per the measurement command.
+ */
+uint16_t
+sdi12_sim::values (int idx, char kind)
+{
+  return std::min (sensors_[idx].values, (uint16_t) (
+      kind == 'H' || kind == 'B' ? 999 : kind == 'C' || kind == 'R' ? 99 : 9));
+}
+
+/**
+ * @brief Start a measurement; continuous measurements return their data
+ *      right away.
+ */
+void
+sdi12_sim::measure (int idx, char kind, uint8_t index, bool crc,
+                    uint64_t start)
+{
+  sensor_t& s = sensors_[idx];
+  state_t& st = states_[idx];
+
+  st.kind = kind;
+  st.index = index;
+  st.crc = crc;
+  st.sample++;
+  st.count = values (idx, kind);
+  if (kind == 'R')
+    {
+      st.ready = 0;
+      data (idx, 0, start);
+      return;
+    }
+
+  char text[8];
+  int len = snprintf (text, sizeof(text), "%c%03u%0*u",
+                      sdi12_dr::index_to_addr (idx), s.ttt % 1000,
+                      kind == 'H' || kind == 'B' ? 3 : kind == 'C' ? 2 : 1,
+                      st.count);
+  answer (idx, text, len, false, start);
+
+  st.ready = line_free_ + (s.ready ? s.ready : s.ttt * 1000) * 1000ULL;
+  st.sr_pending = kind != 'C' && kind != 'H' && kind != 'B'
+      && s.service_request && s.ttt > 0;
+}
+
+/**
+ * @brief Answer a D command (or an R command, page 0): values are packed
+ *      into pages of at most 35 characters for M and V, 75 otherwise.
+ */
+void
+sdi12_sim::data (int idx, int page, uint64_t start)
+{
+  state_t& st = states_[idx];
+  char text[80];
+  size_t len = 0;
+
+  text[len++] = sdi12_dr::index_to_addr (idx);
+  if (st.kind && start >= st.ready)
+    {
+      size_t limit = (st.kind == 'M' || st.kind == 'V') ? 35 : 75;
+      size_t fill = 0;
+      int p = 0;
+
+      for (int i = 0; i < st.count && p <= page; i++)
+        {
+          char v[8];
+          size_t vlen = format (idx, i, v);
+          if (fill + vlen > limit)
+            {
+              if (st.kind == 'R')
+                {
+                  break;        // continuous values fit in one answer
+                }
+              p++;
+              fill = 0;
+            }
+          fill += vlen;
+          if (p == page)
+            {
+              memcpy (text + len, v, vlen);
+              len += vlen;
+            }
+        }
+    }
+  answer (idx, text, len, st.crc, start);
+}
+
+/**
+ * @brief Answer a DB command with a binary packet: as many values as fit
+ *      in the largest payload, in the data type configured for the sensor;
+ *      an empty packet ends the data.
+ */
+void
+sdi12_sim::packet (int idx, int page, uint64_t start)
+{
+  sensor_t& s = sensors_[idx];
+  state_t& st = states_[idx];
+  sdi12_binary::type_t type = (sdi12_binary::type_t) s.binary_type;
+  size_t size = sdi12_binary::type_size (type);
+  char buff[sdi12_binary::header_size + sdi12_binary::max_payload
+      + sdi12_binary::crc_size];
+  size_t len = sdi12_binary::header_size;
+  char addr = sdi12_dr::index_to_addr (idx);
+
+  if (size != 0 && start >= st.ready)
+    {
+      int per_page = sdi12_binary::max_payload / size;
+      for (int i = page * per_page; i < st.count && i < (page + 1) * per_page;
+          i++)
+        {
+          float v = value (addr, i);
+          uint64_t bits;
+          if (type == sdi12_binary::float32)
+            {
+              uint32_t b;
+              memcpy (&b, &v, sizeof(b));
+              bits = b;
+            }
+          else if (type == sdi12_binary::float64)
+            {
+              double d = v;
+              memcpy (&bits, &d, sizeof(bits));
+            }
+          else
+            {
+              bits = (uint64_t) (int64_t) lrintf (v * 100);
+            }
+          for (size_t k = 0; k < size; k++)
+            {
+              buff[len++] = bits >> (8 * k);
+            }
+        }
+    }
+
+  size_t payload = len - sdi12_binary::header_size;
+  buff[0] = addr;
+  buff[1] = payload & 0xFF;
+  buff[2] = payload >> 8;
+  buff[3] = type;
+  uint16_t crc = sdi12_crc::compute (
+      0, reinterpret_cast<const uint8_t*> (buff), len);
+  buff[len++] = crc & 0xFF;
+  buff[len++] = crc >> 8;
+
+  if (random (100) < s.garbage)
+    {
+      buff[random (len)] ^= 1 + random (255);
+      stats_.corrupted++;
+    }
+  transmit (idx, buff, len, start, true);
+}
+
+/**
+ * @brief Queue an answer on the bus, with optional CRC and the CR/LF;
+ *      noise is added as configured for the sensor.
+ * @param idx: index of the answering sensor.
+ * @param text: answer, starting with the address.
+ * @param len: answer length.
+ * @param crc: if true, append the CRC.
+ * @param start: end of the command being answered, in µs.
+ */
+void
+sdi12_sim::answer (int idx, const char* text, size_t len, bool crc,
+                   uint64_t start)
+{
+  sensor_t& s = sensors_[idx];
+  char buff[sdi12_frame::max_length];
+
+  memcpy (buff, text, len);
+  if (crc)
+    {
+      sdi12_crc::to_ascii (
+          sdi12_crc::compute (0, reinterpret_cast<const uint8_t*> (text), len),
+          buff + len);
+      len += 3;
+    }
+  buff[len++] = '\r';
+  buff[len++] = '\n';
+
+  if (random (100) < s.garbage)
+    {
+      for (int k = 1 + random (3); k > 0; k--)
+        {
+          buff[random (len - 2)] = ' ' + random (95);
+        }
+      stats_.corrupted++;
+    }
+  transmit (idx, buff, len, start);
+}
+
+/**
+ * @brief Queue the bytes of an answer on the bus, at 1200 baud timing after
+ *      the turnaround delay; bytes are lost as configured for the sensor.
+ */
+void
+sdi12_sim::transmit (int idx, const char* buff, size_t len, uint64_t start,
+                     bool binary)
+{
+  sensor_t& s = sensors_[idx];
+  uint64_t t = std::max (start, line_free_)
+      + (s.turnaround + random (s.jitter + 1)) * 1000ULL;
+  for (size_t i = 0; i < len; i++)
+    {
+      t += char_time;
+      if (random (100) >= s.drop)
+        {
+          push (t, buff[i], binary);
+        }
+      else
+        {
+          stats_.lost++;
+        }
+    }
+
+  stats_.answers++;
+  stats_.busy += len * char_time;
+  line_free_ = t;
+  awake_until_ = t + sleep_time;
+}
+
+/**
+ * @brief Format a value of the last measurement of a sensor.
+ * @return the number of characters (at most 7).
+ */
+int
+sdi12_sim::format (int idx, int n, char* buff)
+{
+  state_t& st = states_[idx];
+  uint32_t v = (idx * 977 + st.sample * 131 + st.index * 71 + n * 313)
+      % 100000;
+
+  return snprintf (buff, 8, "%c%u.%02u", (n & 1) ? '-' : '+', v / 100,
+                   v % 100);
+}
+
+/**
+ * @brief Send the service requests of the measurements ending until 'until'.
+ */
+void
+sdi12_sim::service_requests (uint64_t until)
+{
+  for (int i = 0; i < max_sensors; i++)
+    {
+      if (states_[i].sr_pending && states_[i].ready <= until)
+        {
+          char a = sdi12_dr::index_to_addr (i);
+          states_[i].sr_pending = false;
+          answer (i, &a, 1, false, states_[i].ready);
+        }
+    }
+}
+
+void
+sdi12_sim::push (uint64_t time, char c, bool binary)
+{
+  if (rx_count_ < rx_size)
+    {
+      rx_[(rx_head_ + rx_count_++) % rx_size] =
+        { time, c, binary };
+    }
+}
+
+/**
+ * @brief Return a byte as the UART receives it with the current setting of
+ *      the port: with 7 data bits, bit 7 of a binary byte is lost (it is
+ *      taken as the parity bit); with 8 data bits, the parity bit of a text
+ *      character becomes bit 7.
+ */
+char
+sdi12_sim::receive (const rx_byte_t& byte)
+{
+  uint8_t c = byte.c;
+
+  if (byte.binary && eight_bits_ == false)
+    {
+      c &= 0x7F;
+    }
+  else if (byte.binary == false && eight_bits_)
+    {
+      c |= __builtin_parity (c) << 7;
+    }
+  return c;
+}
+
+void
+sdi12_sim::wait_until (uint64_t time)
+{
+  clock_->sleep_until (origin_ + (time + 999) / 1000);
+}
+
+/**
+ * @brief Return a pseudo random number between 0 and range - 1 (xorshift).
+ */
+uint32_t
+sdi12_sim::random (uint32_t range)
+{
+  seed_ ^= seed_ << 13;
+  seed_ ^= seed_ >> 17;
+  seed_ ^= seed_ << 5;
+
+  return range ? seed_ % range : 0;
+}
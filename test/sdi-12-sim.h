@@ -0,0 +1,283 @@
+/*
+ * sdi-12-sim.h
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+#ifndef TEST_SDI_12_SIM_H_
+#define TEST_SDI_12_SIM_H_
+
+#include <stdint.h>
+
+#include <cmsis-plus/rtos/os.h>
+#include "dacq-transport.h"
+#include "dacq-clock.h"
+#include "sdi-12-dr.h"
+
+#if defined (__cplusplus)
+
+/*
+ * A virtual SDI-12 bus, used in place of the serial port to test and
+ * benchmark the driver without hardware. Up to 62 scriptable sensors answer
+ * the commands written to the bus; answers are delivered byte by byte at
+ * 1200 baud timing. The sensors go to sleep when the line has been marking
+ * for more than 100 ms, and then ignore commands not preceded by a break.
+ * Noisy sensors can be modelled with random answer delays (jitter), lost
+ * bytes and corrupted answers. With a dacq_virtual_clock installed in both
+ * the simulator and the driver, the bus runs faster than real time.
+ *
+ * Supported commands: a!, aI!, aAb!, ?!, aM!, aMn!, aMC!, aMCn!, aC!, aCn!,
+ * aCC!, aCCn!, aV!, aHA!, aHB!, aD0! to aD9! (aD999! after aHA!), aDB0!
+ * to aDB999! (after aHB!), aR0! to aR9! and aRC0! to aRC9!, and the
+ * metadata commands of all the measurements (e.g. aIM! and aIM_001!). The
+ * data of high volume ASCII measurements and the binary packets always
+ * have a CRC. Text is sent with 7 data bits and even
+ * parity and binary packets with 8 data bits and no parity; bytes received
+ * with the other setting of the port are corrupted as by a real UART.
+ */
+class sdi12_sim : public dacq_transport
+{
+public:
+
+  typedef struct sensor_
+  {
+    bool present;
+    uint16_t ttt;               // announced measurement time, in seconds
+    uint32_t ready;             // actual measurement time, in ms (0: ttt)
+    uint16_t values;            // number of values returned by a measurement
+    bool crc;                   // supports the CRC variants of the commands
+    bool service_request;       // signals the end of an M measurement
+    uint8_t turnaround;         // delay before answering, in ms
+    uint8_t jitter;             // maximum random extra delay, in ms
+    uint8_t drop;               // probability to lose an answer byte, in %
+    uint8_t garbage;            // probability to corrupt an answer, in %
+    uint8_t binary_type;        // data type of the binary packets (HB),
+                                // the integers are the values * 100
+  } sensor_t;
+
+  typedef struct stats_
+  {
+    uint32_t commands;          // complete commands written to the bus
+    uint32_t answers;           // answers sent by sensors
+    uint32_t ignored;           // commands missed by sleeping sensors
+    uint32_t breaks;            // breaks received
+    uint32_t corrupted;         // answers corrupted on purpose (garbage)
+    uint32_t lost;              // answer bytes lost on purpose (drop)
+    uint64_t busy;              // time the line was not marking, in µs
+    uint64_t break_time;        // time spent in breaks, in µs
+  } stats_t;
+
+  sdi12_sim (uint32_t seed = 1);
+
+  sensor_t*
+  add (char addr);
+
+  sensor_t*
+  sensor (char addr);
+
+  void
+  remove (char addr);
+
+  float
+  value (char addr, int index);
+
+  const stats_t&
+  stats (void);
+
+  void
+  reset_stats (void);
+
+  uint64_t
+  now_us (void);
+
+  void
+  set_clock (dacq_clock* clock);
+
+  bool
+  open (void) override;
+
+  void
+  close (void) override;
+
+  bool
+  is_open (void) override;
+
+  bool
+  set_attributes (speed_t baudrate, uint32_t c_size, uint32_t parity,
+                  uint32_t rec_timeout) override;
+
+  ssize_t
+  read (void* buff, size_t count) override;
+
+  ssize_t
+  read (void* buff, size_t count, uint32_t timeout) override;
+
+  ssize_t
+  write (const void* buff, size_t count) override;
+
+  int
+  send_break (int duration) override;
+
+  int
+  flush (int queue) override;
+
+  static constexpr int max_sensors = sdi12_dr::max_addresses;
+
+  // one character at 1200 baud, in µs
+  static constexpr uint32_t char_time = 8333;
+
+  // marking time after which the sensors go to sleep, in µs
+  static constexpr uint32_t sleep_time = 100000;
+
+private:
+
+  typedef struct state_
+  {
+    uint64_t ready;             // time the data is available, in µs
+    uint32_t sample;            // measurement counter, varies the values
+    uint16_t count;             // number of values of the last measurement
+    uint8_t index;              // additional measurement index (Mn, Cn)
+    char kind;                  // 'M', 'C', 'V', 'R', 'H', 'B' or 0 if no
+                                // data
+    bool crc;                   // the data was requested with CRC
+    bool sr_pending;            // a service request is due at 'ready'
+  } state_t;
+
+  typedef struct rx_byte_
+  {
+    uint64_t time;              // time the byte is fully received, in µs
+    char c;
+    bool binary;                // sent with 8 data bits and no parity
+  } rx_byte_t;
+
+  void
+  command (uint64_t start);
+
+  bool
+  measurement (const char* p, size_t n, char& kind, uint8_t& index,
+               bool& crc);
+
+  uint16_t
+  values (int idx, char kind);
+
+  void
+  measure (int idx, char kind, uint8_t index, bool crc, uint64_t start);
+
+  void
+  data (int idx, int page, uint64_t start);
+
+  void
+  packet (int idx, int page, uint64_t start);
+
+  void
+  answer (int idx, const char* text, size_t len, bool crc, uint64_t start);
+
+  void
+  transmit (int idx, const char* buff, size_t len, uint64_t start,
+            bool binary = false);
+
+  int
+  format (int idx, int n, char* buff);
+
+  void
+  service_requests (uint64_t until);
+
+  void
+  push (uint64_t time, char c, bool binary);
+
+  char
+  receive (const rx_byte_t& byte);
+
+  void
+  wait_until (uint64_t time);
+
+  uint32_t
+  random (uint32_t range);
+
+  // room for the largest binary packet
+  static constexpr size_t rx_size = 1024;
+  static constexpr size_t cmd_size = 16;
+
+  sensor_t sensors_[max_sensors];
+  state_t states_[max_sensors];
+
+  rx_byte_t rx_[rx_size];
+  size_t rx_head_ = 0;
+  size_t rx_count_ = 0;
+
+  char cmd_[cmd_size];
+  size_t cmd_len_ = 0;
+  uint64_t cmd_start_ = 0;
+
+  uint64_t line_free_ = 0;      // end of the last character on the line
+  uint64_t awake_until_ = 0;    // the sensors are awake until then
+
+  bool open_ = false;
+  uint32_t rec_timeout_ = 0;
+  bool eight_bits_ = false;     // the port is set to 8 data bits, no parity
+  uint32_t seed_;
+  stats_t stats_;
+  dacq_clock default_clock_;
+  dacq_clock* clock_ = &default_clock_;
+  os::rtos::clock::timestamp_t origin_;
+
+};
+
+/**
+ * @brief Return the configuration of a sensor.
+ * @param addr: sensor's address.
+ * @return a pointer to the configuration, or nullptr if the address is not
+ *      valid.
+ */
+inline sdi12_sim::sensor_t*
+sdi12_sim::sensor (char addr)
+{
+  int idx = sdi12_dr::addr_to_index (addr);
+
+  return idx < 0 ? nullptr : &sensors_[idx];
+}
+
+inline const sdi12_sim::stats_t&
+sdi12_sim::stats (void)
+{
+  return stats_;
+}
+
+inline bool
+sdi12_sim::is_open (void)
+{
+  return open_;
+}
+
+inline ssize_t
+sdi12_sim::read (void* buff, size_t count)
+{
+  return read (buff, count, rec_timeout_);
+}
+
+#endif /* (__cplusplus) */
+
+#endif /* TEST_SDI_12_SIM_H_ */
@@ -0,0 +1,802 @@
+/*
+ * test-sdi12sim.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+/*
+ * Exercises the SDI-12 driver against the simulated bus; no hardware is
+ * needed, so the test can also run on a Linux host. The bus runs on a
+ * virtual clock, so the test completes in a fraction of the simulated time.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include "test-sdi12sim.h"
+#include "sdi-12-sim.h"
+#include "sdi-12-dr.h"
+#include "sdi-12-manager.h"
+#include "sysconfig.h"
+
+#if SDI12_SIM_TEST == true
+
+using namespace os;
+using namespace os::rtos;
+
+static dacq_virtual_clock vclock;
+
+static sdi12_sim sim;
+
+static sdi12_dr sdi12dr
+  { sim };
+
+/**
+ * @brief Compare the values returned by the driver with the ones sent by
+ *      the simulated sensor.
+ * @return true if all values match, false otherwise.
+ */
+static bool
+check_values (dacq::dacq_handle_t* dacqh, uint16_t expected)
+{
+  char addr = static_cast<sdi12_dr::sdi12_t*> (dacqh->impl)->addr;
+
+  if (dacqh->data_count != expected)
+    {
+      trace::printf ("Sensor %c: got %d values instead of %d\n", addr,
+                     dacqh->data_count, expected);
+      return false;
+    }
+  for (int i = 0; i < dacqh->data_count; i++)
+    {
+      if (dacqh->data[i] != sim.value (addr, i) || dacqh->status[i] != 0)
+        {
+          trace::printf ("Sensor %c: value %d is %f instead of %f\n", addr,
+                         i, dacqh->data[i], sim.value (addr, i));
+          return false;
+        }
+    }
+  return true;
+}
+
+static int dumped;
+
+static void
+dump_line (char* line)
+{
+  if (strstr (line, " --> 0I!") != nullptr
+      || strstr (line, " <-- 013VIRTUAL") != nullptr)
+    {
+      dumped++;
+    }
+}
+
+static int dumped_commands;
+static bool dump_lost;
+
+static void
+dump_count (char* line)
+{
+  if (strstr (line, " --> ") != nullptr && strstr (line, " --> break") == nullptr)
+    {
+      dumped_commands++;
+    }
+  dump_lost = dump_lost || strstr (line, "events lost") != nullptr;
+}
+
+static int dispatched;
+
+static bool
+cb_count (void* param)
+{
+  (void) param;
+  dispatched++;
+  return true;
+}
+
+#if MAX_CONCURRENT_REQUESTS > 0
+static semaphore_binary done
+  { "sim-done", 0 };
+static bool concurrent_ok;
+
+static bool
+cb_check (void* param)
+{
+  dacq::dacq_handle_t* dacqh = (dacq::dacq_handle_t*) param;
+
+  concurrent_ok = check_values (dacqh, 12);
+  done.post ();
+  return true;
+}
+#endif
+
+/**
+ * @brief  This is a test function that exercises the SDI-12 library on a
+ *      simulated bus.
+ */
+void
+test_sdi12_sim (void)
+{
+  char buff[100];
+  bool result = false;
+
+  class dacq* dacqp = &sdi12dr;
+
+  sim.set_clock (&vclock);
+  sdi12dr.set_clock (&vclock);
+  vclock.attach ();
+
+  // sensor 0: M measurement with service request, five values
+  sdi12_sim::sensor_t* s = sim.add ('0');
+  s->values = 5;
+
+  // sensor A: C measurement, two seconds, twelve values
+  s = sim.add ('A');
+  s->ttt = 2;
+  s->values = 12;
+
+  // sensor z: continuous measurements, slow to answer
+  s = sim.add ('z');
+  s->values = 4;
+  s->turnaround = 15;
+
+  // sensor h: high volume ASCII measurement, 250 values in 24 pages
+  s = sim.add ('h');
+  s->values = 250;
+
+  // sensor b: high volume binary measurement, 300 values in 2 packets
+  s = sim.add ('b');
+  s->values = 300;
+
+  do
+    {
+      // open sdi12 port: 1200 Baud, 7 bits, even parity, 50 ms timeout
+      if (dacqp->open (1200, CS7, PARENB, 50) == false)
+        {
+          trace::printf ("Serial port: %s\n", dacqp->error->error_text);
+          break;
+        }
+
+      // identification command (aI!)
+      if (dacqp->get_info ('0', buff, sizeof(buff)) == false
+          || strncmp (buff, "13VIRTUAL", 9) != 0)
+        {
+          trace::printf ("Get sensor ID: %s\n", dacqp->error->error_text);
+          break;
+        }
+
+      // the same, traced: formatted for the dump function, then recorded
+      // in binary form and decoded
+      static sdi12_trace bus_trace;
+      static uint8_t raw[sdi12_trace::capacity];
+      dumped = 0;
+      dacqp->set_dump_fn (dump_line);
+      bool traced = dacqp->get_info ('0', buff, sizeof(buff)) && dumped == 2;
+      dacqp->unset_dump_fn ();
+      sdi12dr.set_trace (&bus_trace);
+      traced = traced && dacqp->get_info ('0', buff, sizeof(buff));
+      sdi12dr.set_trace (nullptr);
+      size_t count = bus_trace.read (raw, sizeof(raw));
+      size_t pos = 0;
+      size_t n;
+      uint32_t high = 0;
+      sdi12_trace::event_t event;
+      int events = 0;
+      while ((n = sdi12_trace::decode (raw + pos, count - pos, high, event)) > 0)
+        {
+          pos += n;
+          if ((event.type == sdi12_trace::command && event.length == 3
+              && memcmp (event.data, "0I!", 3) == 0)
+              || (event.type == sdi12_trace::answer && event.data[0] == '0'))
+            {
+              events++;
+            }
+        }
+      if (traced == false || events != 2 || bus_trace.dropped () != 0)
+        {
+          trace::printf ("Trace failed\n");
+          break;
+        }
+
+      // change address from 0 to 1 and back
+      if (dacqp->change_id ('0', '1') == false || sim.sensor ('0')->present
+          || dacqp->change_id ('1', '0') == false)
+        {
+          trace::printf ("Address change failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+
+      // discovery: all the sensors, also when the wildcard collides
+      uint64_t expected = 0;
+      uint64_t found;
+      for (char addr : "0Azhb")
+        {
+          if (addr != '\0')
+            {
+              expected |= 1ULL << sdi12_dr::addr_to_index (addr);
+            }
+        }
+      if (sdi12dr.discover (found) == false || found != expected
+          || sdi12dr.discover (found, true) == false || found != expected)
+        {
+          trace::printf ("Discovery failed: %s\n", dacqp->error->error_text);
+          break;
+        }
+
+      // measure (M with D), with and without CRC
+      float data[20];
+      uint8_t status[20];
+      dacq::dacq_handle_t dacqh;
+      sdi12_dr::sdi12_t sdi;
+      dacqh.data = data;
+      dacqh.status = status;
+      dacqh.cb = nullptr;
+      dacqh.cb_parameter = nullptr;
+      dacqh.impl = (void *) &sdi;
+      sdi.addr = '0';
+      sdi.method = sdi12_dr::measure;
+      sdi.index = 0;
+      sdi.max_waiting = 0;
+      sdi.use_crc = false;
+      sdi.strict_break = false;
+      sdi.fixed = nullptr;
+
+      dacqh.data_count = sizeof(data) / sizeof(data[0]);
+      sdi12dr.set_date (1000000000);
+      if (dacqp->retrieve (&dacqh) == false || !check_values (&dacqh, 5))
+        {
+          trace::printf ("M measurement failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+      // the data is received after the service request, and both are
+      // timestamped on the wall clock
+      if (dacqh.received <= dacqh.ready || dacqh.received - dacqh.ready > 500000
+          || dacqh.date < 1000000000
+          || dacqh.date != (time_t) (dacqh.ready / 1000000))
+        {
+          trace::printf ("M measurement timestamps wrong\n");
+          break;
+        }
+      sdi12dr.set_date (2000000000);
+      sdi.method = sdi12_dr::measure;   // retrieve() changed it to data
+      sdi.use_crc = true;
+      sdi.index = 3;
+      dacqh.data_count = sizeof(data) / sizeof(data[0]);
+      if (dacqp->retrieve (&dacqh) == false || !check_values (&dacqh, 5)
+          || dacqh.date < 2000000000 || dacqh.date > sdi12dr.get_date ())
+        {
+          trace::printf ("MC3 measurement failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+
+      // the same values as mantissa and exponent, aggregated without float
+      dacq_fixed_t fixed[20];
+      dacq_fixed_acc acc;
+      sdi.method = sdi12_dr::measure;
+      sdi.index = 0;
+      sdi.fixed = fixed;
+      dacqh.data_count = sizeof(data) / sizeof(data[0]);
+      bool fixed_ok = dacqp->retrieve (&dacqh) && dacqh.data_count == 5;
+      sdi.fixed = nullptr;
+      for (int i = 0; fixed_ok && i < dacqh.data_count; i++)
+        {
+          fixed_ok = fixed[i].exponent == -2 && status[i] == 0
+              && dacq_fixed::to_float (fixed[i]) == sim.value ('0', i);
+          acc.add (fixed[i]);
+        }
+      if (fixed_ok == false || acc.count () != 5
+          || dacq_fixed::compare (acc.min (), acc.mean ()) > 0
+          || dacq_fixed::compare (acc.mean (), acc.max ()) > 0)
+        {
+          trace::printf ("Fixed-point measurement failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+
+      // a punctual sensor that becomes 300 ms late: the grace period
+      // learned meanwhile must not cost the measurement
+      bool punctual = true;
+      for (int i = 0; i < 5 && punctual; i++)
+        {
+          sim.sensor ('0')->ready = i < 4 ? 0 : 1300;
+          sdi.method = sdi12_dr::measure;
+          dacqh.data_count = sizeof(data) / sizeof(data[0]);
+          punctual = dacqp->retrieve (&dacqh) && check_values (&dacqh, 5);
+        }
+      sim.sensor ('0')->ready = 0;
+      if (punctual == false)
+        {
+          trace::printf ("Late service request failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+
+      // continuous measurement (R), after the sensors went to sleep
+      vclock.sleep_for (200);
+      sdi.addr = 'z';
+      sdi.method = sdi12_dr::continuous;
+      sdi.index = 0;
+      dacqh.data_count = 4;
+      if (dacqp->retrieve (&dacqh) == false || !check_values (&dacqh, 4))
+        {
+          trace::printf ("R measurement failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+
+      // high volume ASCII measurement (HA), data pages D0 to D23, always
+      // with CRC
+      static float many[999];
+      static uint8_t many_status[999];
+      sdi.addr = 'h';
+      sdi.method = sdi12_dr::high_volume_ascii;
+      sdi.use_crc = false;
+      dacqh.data = many;
+      dacqh.status = many_status;
+      dacqh.data_count = sizeof(many) / sizeof(many[0]);
+      bool high_volume = dacqp->retrieve (&dacqh)
+          && check_values (&dacqh, 250);
+      // the same, dumped: every command of the 24 pages must reach the
+      // dump function
+      dumped_commands = 0;
+      dump_lost = false;
+      uint32_t paged = sim.stats ().commands;
+      dacqp->set_dump_fn (dump_count);
+      sdi.method = sdi12_dr::high_volume_ascii;
+      dacqh.data_count = sizeof(many) / sizeof(many[0]);
+      high_volume = high_volume && dacqp->retrieve (&dacqh)
+          && check_values (&dacqh, 250);
+      dacqp->unset_dump_fn ();
+      high_volume = high_volume && dump_lost == false
+          && dumped_commands == (int) (sim.stats ().commands - paged);
+      if (high_volume == false)
+        {
+          trace::printf ("HA measurement failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+
+      // high volume binary measurement (HB), float and integer packets
+      sdi.addr = 'b';
+      sdi.method = sdi12_dr::high_volume_binary;
+      dacqh.data_count = sizeof(many) / sizeof(many[0]);
+      high_volume = dacqp->retrieve (&dacqh) && check_values (&dacqh, 300);
+      sim.sensor ('b')->binary_type = sdi12_binary::int32;
+      sdi.method = sdi12_dr::high_volume_binary;
+      dacqh.data_count = sizeof(many) / sizeof(many[0]);
+      high_volume = high_volume && dacqp->retrieve (&dacqh)
+          && dacqh.data_count == 300;
+      for (int i = 0; high_volume && i < dacqh.data_count; i++)
+        {
+          high_volume = many[i] == lrintf (sim.value ('b', i) * 100)
+              && many_status[i] == 0;
+        }
+      dacqh.data = data;
+      dacqh.status = status;
+      // a corrupt payload size ends the packet with its header
+      static const uint8_t corrupt[] =
+        { 'b', 0xFF, 0xFF, sdi12_binary::float32, 0x00 };
+      sdi12_binary packet;
+      packet.begin (many, 1);
+      high_volume = high_volume && packet.put (corrupt, 4)
+          && packet.wanted () == 0 && packet.valid () == false
+          && packet.crc_valid () == false && packet.put (corrupt + 4, 1)
+          && packet.count () == 0;
+      if (high_volume == false)
+        {
+          trace::printf ("HB measurement failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+
+      // metadata (aIM!, aIR0!, aIM_002!): learn two measurements, once,
+      // then save the cache and load it again
+      static sdi12_schema schema;
+      static sdi12_schema restored;
+      static uint8_t blob[sdi12_schema::blob_size];
+      sdi12dr.set_schema (&schema);
+      sdi.addr = '0';
+      sdi.method = sdi12_dr::measure;
+      sdi.index = 0;
+      bool learned = sdi12dr.learn (&sdi);
+      uint32_t commands = sim.stats ().commands;
+      learned = learned && sdi12dr.learn (&sdi)
+          && sim.stats ().commands == commands + 1;   // known, only aI!
+      char param[16];
+      learned = learned && sdi12dr.get_parameter (&sdi, 2, param, sizeof(param))
+          && strcmp (param, "P2,U2") == 0
+          && sdi12dr.get_parameter (&sdi, 6, param, sizeof(param)) == false;
+      sdi.addr = 'z';
+      sdi.method = sdi12_dr::continuous;
+      learned = learned && sdi12dr.learn (&sdi);
+      sdi12dr.set_schema (nullptr);
+      size_t saved = schema.save (blob, sizeof(blob));
+      sdi12_schema::entry_t known;
+      learned = learned && saved > 0 && restored.load (blob, saved)
+          && restored.size () == 2
+          && restored.find ('0', sdi12_dr::measure, 0, known)
+          && known.values == 5 && known.ttt == 1
+          && restored.find ('z', sdi12_dr::continuous, 0, known)
+          && known.values == 4;
+      // a damaged blob is refused, another sensor drops the entries
+      blob[9] ^= 1;
+      learned = learned && restored.load (blob, saved) == false
+          && restored.check ('0', 0) == false && restored.size () == 1;
+      if (learned == false)
+        {
+          trace::printf ("Metadata failed: %s\n", dacqp->error->error_text);
+          break;
+        }
+
+#if MAX_CONCURRENT_REQUESTS > 0
+      // asynchronous measure (C with D)
+      sdi.addr = 'A';
+      sdi.method = sdi12_dr::concurrent;
+      dacqh.data_count = sizeof(data) / sizeof(data[0]);
+      dacqh.cb = cb_check;
+      if (dacqp->retrieve (&dacqh) == false)
+        {
+          trace::printf ("C measurement failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+
+      // while the request is pending, the sensor and the table are busy
+      if (dacqp->retrieve (&dacqh) == true
+          || dacqp->error->error_number != dacq::sensor_busy
+          || sdi12dr.set_max_concurrent (MAX_CONCURRENT_REQUESTS + 1) == true)
+        {
+          trace::printf ("Second C request accepted\n");
+          break;
+        }
+      if (vclock.timed_wait (done, 5000) != 0 || concurrent_ok == false)
+        {
+          trace::printf ("C measurement failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+      dacqh.cb = nullptr;
+
+      // grow the request table beyond the static one and back
+      if (sdi12dr.set_max_concurrent (sdi12_dr::max_addresses) == false
+          || sdi12dr.max_concurrent () != sdi12_dr::max_addresses
+          || sdi12dr.set_max_concurrent (MAX_CONCURRENT_REQUESTS) == false)
+        {
+          trace::printf ("Request table resize failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+#endif
+
+      // one planned sweep of all three sensors (M, C and R)
+      static float sweep_data[3][20];
+      static uint8_t sweep_status[3][20];
+      static const char addrs[3] =
+        { '0', 'A', 'z' };
+      static const sdi12_dr::method_t methods[3] =
+        { sdi12_dr::measure, sdi12_dr::concurrent, sdi12_dr::continuous };
+      static const uint8_t counts[3] =
+        { 5, 12, 4 };
+      dacq::dacq_handle_t sweep_dh[3];
+      sdi12_dr::sdi12_t sweep_sdi[3];
+      dacq::dacq_handle_t* handles[3];
+      for (int i = 0; i < 3; i++)
+        {
+          sweep_dh[i] = dacqh;
+          sweep_dh[i].data = sweep_data[i];
+          sweep_dh[i].status = sweep_status[i];
+          sweep_dh[i].data_count = counts[i];
+          sweep_dh[i].impl = &sweep_sdi[i];
+          sweep_sdi[i] = sdi;
+          sweep_sdi[i].addr = addrs[i];
+          sweep_sdi[i].method = methods[i];
+          sweep_sdi[i].index = 0;
+          handles[i] = &sweep_dh[i];
+        }
+      if (sdi12dr.retrieve_many (handles, 3) == false)
+        {
+          trace::printf ("Planned sweep failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+      int checked = 0;
+      while (checked < 3 && check_values (&sweep_dh[checked], counts[checked]))
+        {
+          checked++;
+        }
+      if (checked < 3)
+        {
+          break;
+        }
+
+#if MAX_CONCURRENT_REQUESTS > 0
+      // asynchronous M and C, the caller does not wait for the bus
+      static dacq_completion completions[2];
+      clock::timestamp_t queued = vclock.now ();
+      for (int i = 0; i < 2; i++)
+        {
+          sweep_dh[i].data_count = 20;
+          sweep_sdi[i].method = methods[i];
+          if (sdi12dr.retrieve_async (&sweep_dh[i], &completions[i]) == false)
+            {
+              break;
+            }
+        }
+      // a handle still following a request is not reused for another
+      bool refused = sdi12dr.retrieve_async (&sweep_dh[2], &completions[0])
+          == false && dacqp->error->error_number == dacq::completion_busy;
+      if (vclock.now () != queued || refused == false
+          || completions[0].wait (5000) == false
+          || completions[1].wait (5000) == false)
+        {
+          trace::printf ("Asynchronous retrieval failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+      if (completions[0].result () == false || completions[0].count () != 5
+          || completions[1].result () == false || completions[1].count () != 12)
+        {
+          trace::printf ("Asynchronous retrieval returned no data\n");
+          break;
+        }
+
+      // the same sensors, swept by a manager (a single bus here)
+      sdi12_dr* buses[1] =
+        { &sdi12dr };
+      sdi12_manager manager
+        { buses, 1 };
+      manager.set_clock (&vclock);
+      for (int i = 0; i < 2; i++)
+        {
+          sweep_dh[i].data_count = counts[i];
+          sweep_sdi[i].method = methods[i];
+          manager.add (0, &sweep_dh[i]);
+        }
+      if (manager.add (0, &sweep_dh[0]) == true || manager.run (10000) == false
+          || !check_values (&sweep_dh[0], counts[0]))
+        {
+          trace::printf ("Manager sweep failed\n");
+          break;
+        }
+#endif
+
+      // a sweep with deferred call-backs, called when the queue is drained
+      static dacq_dispatch queue;
+      sdi12dr.set_dispatch (&queue);
+      for (int i = 0; i < 3; i++)
+        {
+          sweep_dh[i].data_count = counts[i];
+          sweep_sdi[i].method = methods[i];
+          sweep_dh[i].cb = cb_count;
+        }
+      dispatched = 0;
+      bool swept = sdi12dr.retrieve_many (handles, 3);
+      sdi12dr.set_dispatch (nullptr);
+      if (swept == false || dispatched != 0 || queue.pending () != 3
+          || queue.drain () != 3 || dispatched != 3
+          || queue.stats ().overflows != 0)
+        {
+          trace::printf ("Deferred call-backs failed\n");
+          break;
+        }
+
+#if MAX_CONCURRENT_REQUESTS > 0
+      // C measurement into the driver-owned result ring, without arrays
+      static sdi12_results results;
+      static dacq_completion ring_done;
+      sdi12dr.set_results (&results);
+      sweep_dh[1].data = nullptr;
+      sweep_dh[1].status = nullptr;
+      sweep_dh[1].data_count = counts[1];
+      sweep_dh[1].cb = nullptr;
+      sweep_sdi[1].method = sdi12_dr::concurrent;
+      swept = sdi12dr.retrieve_async (&sweep_dh[1], &ring_done)
+          && ring_done.wait (5000) && ring_done.result ();
+      sdi12dr.set_results (nullptr);
+      if (swept == false || results.available () != 1
+          || results.front ()->addr != 'A' || results.front ()->count != 12
+          || results.front ()->received <= results.front ()->ready)
+        {
+          trace::printf ("Result ring failed\n");
+          break;
+        }
+      for (int i = 0; i < 12; i++)
+        {
+          if (results.front ()->values[i] != sim.value ('A', i)
+              || results.front ()->status[i] != 0)
+            {
+              swept = false;
+            }
+        }
+      results.pop ();
+      if (swept == false || results.available () != 0)
+        {
+          trace::printf ("Result ring returned wrong values\n");
+          break;
+        }
+#endif
+
+      // no command may have been missed by a sleeping sensor
+      if (sim.stats ().ignored != 0)
+        {
+          trace::printf ("%u commands without break\n",
+                         sim.stats ().ignored);
+          break;
+        }
+
+      // a sensor not on the bus must time out; both it and a regular
+      // measurement are accounted for in the per-sensor statistics,
+      // including the bus time saved by the retry policy
+      static sdi12_stats stats;
+      sdi12dr.set_stats (&stats);
+      sdi.addr = '0';
+      sdi.method = sdi12_dr::measure;
+      dacqh.data_count = sizeof(data) / sizeof(data[0]);
+      bool counted = dacqp->retrieve (&dacqh);
+      sdi.addr = '5';
+      dacqh.data_count = sizeof(data) / sizeof(data[0]);
+      if (dacqp->retrieve (&dacqh) == true)
+        {
+          trace::printf ("Absent sensor answered\n");
+          break;
+        }
+
+      // now it is known to be dead: the next command is not sent, a single
+      // attempt is made after the backoff, and an answer revives it
+      uint32_t sent = sim.stats ().commands;
+      dacqh.data_count = sizeof(data) / sizeof(data[0]);
+      bool backed_off = dacqp->retrieve (&dacqh) == false
+          && sim.stats ().commands == sent;
+      vclock.sleep_for (SDI_RETRY_BACKOFF);
+      dacqh.data_count = sizeof(data) / sizeof(data[0]);
+      backed_off = backed_off && dacqp->retrieve (&dacqh) == false
+          && sim.stats ().commands == sent + 1;
+      sim.add ('5')->values = 3;
+      vclock.sleep_for (2 * SDI_RETRY_BACKOFF);
+      sdi.method = sdi12_dr::measure;
+      sdi.index = 0;
+      dacqh.data_count = sizeof(data) / sizeof(data[0]);
+      backed_off = backed_off && dacqp->retrieve (&dacqh)
+          && dacqh.data_count == 3;
+      sim.remove ('5');
+      sdi12dr.set_stats (nullptr);
+      if (backed_off == false)
+        {
+          trace::printf ("Retry policy failed: %s\n",
+                         dacqp->error->error_text);
+          break;
+        }
+
+      sdi12_stats::entry_t entry;
+      uint32_t answers = 0;
+      stats.snapshot (sdi12_dr::addr_to_index ('0'), entry, true);
+      for (int i = 0; i < sdi12_stats::buckets; i++)
+        {
+          answers += entry.answer[i];
+        }
+      counted = counted && entry.count[sdi12_stats::transactions] >= 2
+          && entry.count[sdi12_stats::timeouts] == 0 && entry.responses == 1
+          && answers == entry.count[sdi12_stats::transactions];
+      stats.snapshot (sdi12_dr::addr_to_index ('5'), entry);
+      counted = counted && entry.count[sdi12_stats::timeouts] > 0
+          && entry.count[sdi12_stats::retries] > 0
+          && entry.count[sdi12_stats::skipped] > 0 && entry.saved_ms > 0
+          && stats.active () == 1ULL << sdi12_dr::addr_to_index ('5');
+      if (counted == false)
+        {
+          trace::printf ("Statistics not as expected\n");
+          break;
+        }
+
+      // noisy sensor: most retrievals succeed through the retries (the
+      // ones that get three bad answers in a row fail), the values are
+      // never wrong, and the errors counted by the driver were all injected
+      // by the simulator
+      static sdi12_stats noise;
+      s = sim.add ('n');
+      s->values = 5;
+      s->jitter = 20;
+      s->drop = 2;
+      s->garbage = 20;
+      sim.reset_stats ();
+      sdi12dr.set_stats (&noise);
+      sdi.addr = 'n';
+      sdi.use_crc = true;
+      int noisy_ok = 0;
+      bool noisy_values = true;
+      for (int i = 0; i < 20; i++)
+        {
+          sdi.method = sdi12_dr::measure;
+          sdi.index = 0;
+          dacqh.data_count = sizeof(data) / sizeof(data[0]);
+          if (dacqp->retrieve (&dacqh) == true)
+            {
+              noisy_values = check_values (&dacqh, 5) && noisy_values;
+              noisy_ok++;
+            }
+        }
+      noise.snapshot (sdi12_dr::addr_to_index ('n'), entry);
+      uint32_t detected = entry.count[sdi12_stats::crc_errors]
+          + entry.count[sdi12_stats::unexpected]
+          + entry.count[sdi12_stats::parse_errors];
+      bool noisy = noisy_ok >= 15 && noisy_values
+          && sim.stats ().corrupted > 0 && sim.stats ().lost > 0
+          && entry.count[sdi12_stats::crc_errors] > 0
+          && entry.count[sdi12_stats::unexpected] > 0
+          && entry.count[sdi12_stats::retries] > 0
+          && detected + entry.count[sdi12_stats::timeouts]
+              <= sim.stats ().corrupted + sim.stats ().lost;
+
+      // a sensor losing all its bytes ends in a timeout
+      sim.add ('x')->drop = 100;
+      sdi.addr = 'x';
+      sdi.method = sdi12_dr::measure;
+      dacqh.data_count = sizeof(data) / sizeof(data[0]);
+      noisy = noisy && dacqp->retrieve (&dacqh) == false
+          && dacqp->error->error_number == dacq::timeout;
+      noise.snapshot (sdi12_dr::addr_to_index ('x'), entry);
+      noisy = noisy && entry.count[sdi12_stats::timeouts] > 0
+          && entry.count[sdi12_stats::transactions] > 0;
+      sdi12dr.set_stats (nullptr);
+      sim.remove ('n');
+      sim.remove ('x');
+      if (noisy == false)
+        {
+          trace::printf ("Noisy sensor: %d of 20, %u corrupted, %u lost, "
+                         "%u detected\n",
+                         noisy_ok, sim.stats ().corrupted, sim.stats ().lost,
+                         detected);
+          break;
+        }
+
+      sdi12dr.close ();
+      result = true;
+    }
+  while (0);
+
+  trace::printf ("Simulated time %u ms\n", (uint32_t) vclock.now ());
+  vclock.detach ();
+  sdi12dr.set_clock (nullptr);
+  sim.set_clock (nullptr);
+
+  if (result == false)
+    {
+      trace::printf ("SDI-12 simulator test failed\n");
+    }
+  else
+    {
+      trace::printf ("SDI-12 simulator test successful\n");
+    }
+}
+
+#endif // SDI12_SIM_TEST == true
@@ -0,0 +1,111 @@
+/*
+ * sdi12-trace-decode.cpp
+ *
+ * Copyright (c) 2026 Lix N. Paulian (lix@paulian.net)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Created on: 16 Oct 2026 (LNP)
+ */
+
+/*
+ * Host tool decoding the bus events recorded by an sdi12_trace, as read
+ * with sdi12_trace::read() and saved or forwarded as they are, e.g.:
+ *
+ *   g++ -Isrc tools/sdi12-trace-decode.cpp src/sdi-12-trace.cpp \
+ *       -o sdi12-trace-decode
+ *   ./sdi12-trace-decode trace.bin
+ *
+ * Each event is printed on a line, with the times in ms relative to the
+ * first event; with -a, the times of the events are printed as well, in
+ * µs of the clock of the driver (or of the wall clock, see
+ * sdi12_dr::set_date()).
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "sdi-12-trace.h"
+
+int
+main (int argc, char* argv[])
+{
+  static uint8_t buff[4096];
+  FILE* in = stdin;
+  bool absolute = false;
+  uint64_t base = 0;
+  uint32_t high = 0;
+  size_t fill = 0;
+  size_t count;
+
+  for (int i = 1; i < argc; i++)
+    {
+      if (strcmp (argv[i], "-a") == 0)
+        {
+          absolute = true;
+        }
+      else if ((in = fopen (argv[i], "rb")) == nullptr)
+        {
+          perror (argv[i]);
+          return 1;
+        }
+    }
+
+  while ((count = fread (buff + fill, 1, sizeof(buff) - fill, in)) > 0)
+    {
+      size_t pos = 0;
+      size_t n;
+      sdi12_trace::event_t event;
+      char text[128];
+
+      fill += count;
+      while ((n = sdi12_trace::decode (buff + pos, fill - pos, high, event))
+          > 0)
+        {
+          pos += n;
+          if (event.type == sdi12_trace::time_high)
+            {
+              continue;
+            }
+          base = base ? base : event.time;
+          if (sdi12_trace::format (event, base, text, sizeof(text)) > 0)
+            {
+              if (absolute)
+                {
+                  printf ("%" PRIu64 " ", event.time);
+                }
+              printf ("%s\n", text);
+            }
+        }
+      // keep the incomplete event for the next read
+      fill -= pos;
+      memmove (buff, buff + pos, fill);
+    }
+
+  if (fill > 0)
+    {
+      fprintf (stderr, "%zu bytes left, truncated event\n", fill);
+    }
+
+  return 0;
+}